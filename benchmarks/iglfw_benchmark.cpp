@@ -0,0 +1,223 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+// Benchmarks for the platform layer. All benchmarks run on the null platform, so no display server is required.
+// Usage: iglfw_benchmark [--output <file.json>] [--iterations <count>]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+import pragma.platform;
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	struct BenchmarkResult {
+		std::string name;
+		// Number of operations performed per iteration, e.g. the number of dispatched events
+		uint64_t itemsPerIteration = 1;
+		std::vector<uint64_t> samples;
+	};
+
+	template<typename TFunc>
+	BenchmarkResult run_benchmark(std::string name, uint32_t iterations, uint64_t itemsPerIteration, TFunc &&func)
+	{
+		BenchmarkResult result {std::move(name), itemsPerIteration};
+		result.samples.reserve(iterations);
+		// Warm-up
+		for(uint32_t i = 0; i < std::max(iterations / 10, 1u); ++i)
+			func();
+		for(uint32_t i = 0; i < iterations; ++i) {
+			auto t = Clock::now();
+			func();
+			auto dt = Clock::now() - t;
+			result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+		}
+		std::cerr << "Completed benchmark '" << result.name << "'" << std::endl;
+		return result;
+	}
+
+	std::string to_json(const std::vector<BenchmarkResult> &results)
+	{
+		std::string json = "{\n\t\"benchmarks\": [\n";
+		for(size_t i = 0; i < results.size(); ++i) {
+			auto samples = results[i].samples;
+			std::sort(samples.begin(), samples.end());
+			uint64_t total = 0;
+			for(auto v : samples)
+				total += v;
+			auto n = samples.size();
+			auto percentile = [&samples, n](double p) { return n > 0 ? samples[std::min(static_cast<size_t>(p * static_cast<double>(n)), n - 1)] : 0; };
+			auto mean = n > 0 ? static_cast<double>(total) / static_cast<double>(n) : 0.0;
+			auto itemsPerSecond = (mean > 0.0) ? static_cast<double>(results[i].itemsPerIteration) / (mean / 1'000'000'000.0) : 0.0;
+			json += std::format("\t\t{{\"name\": \"{}\", \"iterations\": {}, \"items_per_iteration\": {}, \"min_ns\": {}, \"mean_ns\": {:.1f}, \"median_ns\": {}, \"p99_ns\": {}, \"max_ns\": {}, \"items_per_second\": {:.1f}}}", results[i].name, n,
+			  results[i].itemsPerIteration, n > 0 ? samples.front() : 0, mean, percentile(0.5), percentile(0.99), n > 0 ? samples.back() : 0, itemsPerSecond);
+			json += (i + 1 < results.size()) ? ",\n" : "\n";
+		}
+		json += "\t]\n}\n";
+		return json;
+	}
+
+	std::unique_ptr<pragma::platform::Window> create_window()
+	{
+		pragma::platform::WindowCreationInfo info {};
+		info.title = "iglfw_benchmark";
+		info.width = 320;
+		info.height = 240;
+		info.flags = pragma::platform::WindowCreationInfo::Flags::Windowless;
+		auto window = pragma::platform::Window::Create(info);
+		if(!window) {
+			std::cerr << "Failed to create window: " << window.error() << std::endl;
+			return nullptr;
+		}
+		return std::move(*window);
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	std::string outputFile;
+	uint32_t iterations = 1'000;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--output" && i + 1 < argc)
+			outputFile = argv[++i];
+		else if(arg == "--iterations" && i + 1 < argc)
+			iterations = std::max(std::stoul(argv[++i]), 1ul);
+	}
+
+	pragma::platform::InitInfo initInfo {};
+	initInfo.headless = true;
+	std::vector<BenchmarkResult> results;
+
+	results.push_back(run_benchmark("initialize_terminate", std::max(iterations / 20, 1u), 1, [&initInfo]() {
+		if(!pragma::platform::initialize(initInfo))
+			return;
+		pragma::platform::terminate();
+	}));
+
+	if(auto res = pragma::platform::initialize(initInfo); !res) {
+		std::cerr << "Failed to initialize platform: " << res.error() << std::endl;
+		return 1;
+	}
+
+	results.push_back(run_benchmark("window_create_destroy", std::max(iterations / 10, 1u), 1, []() { create_window(); }));
+
+	for(uint32_t windowCount : {1u, 8u, 32u}) {
+		std::vector<std::unique_ptr<pragma::platform::Window>> windows;
+		for(uint32_t i = 0; i < windowCount; ++i)
+			windows.push_back(create_window());
+		results.push_back(run_benchmark(std::format("poll_events/{}", windowCount), iterations, 1, []() { pragma::platform::poll_events(); }));
+	}
+
+	{
+		constexpr uint32_t eventCount = 1'000;
+		auto window = create_window();
+		uint64_t keyCount = 0;
+		window->SetKeyCallback([&keyCount](pragma::platform::Window &, pragma::platform::Key, int, pragma::platform::KeyState, pragma::platform::Modifier) { ++keyCount; });
+		window->SetCursorPosCallback([&keyCount](pragma::platform::Window &, auto) { ++keyCount; });
+		auto injectEvents = [&window]() {
+			pragma::platform::InputEvent ev {pragma::platform::InputEvent::Type::Key};
+			for(uint32_t i = 0; i < eventCount; ++i) {
+				ev.key = {pragma::platform::Key::A, 0, (i % 2 == 0) ? pragma::platform::KeyState::Press : pragma::platform::KeyState::Release, pragma::platform::Modifier::None};
+				window->InjectEvent(ev);
+			}
+		};
+		results.push_back(run_benchmark("callback_dispatch/key", iterations, eventCount, injectEvents));
+
+		results.push_back(run_benchmark("callback_dispatch/cursor_pos", iterations, eventCount, [&window]() {
+			pragma::platform::InputEvent ev {pragma::platform::InputEvent::Type::CursorPos};
+			for(uint32_t i = 0; i < eventCount; ++i) {
+				ev.cursorPos = {static_cast<float>(i), static_cast<float>(i), 0.f, 0.f};
+				window->InjectEvent(ev);
+			}
+		}));
+
+		window->SetEventQueueEnabled(true);
+		results.push_back(run_benchmark("callback_dispatch/key_queued", iterations, eventCount, [&window, &injectEvents]() {
+			injectEvents();
+			window->DispatchQueuedEvents();
+		}));
+		window->SetEventQueueEnabled(false);
+
+		window->SetInputCoalescingEnabled(true);
+		results.push_back(run_benchmark("callback_dispatch/cursor_pos_coalesced", iterations, eventCount, [&window]() {
+			pragma::platform::InputEvent ev {pragma::platform::InputEvent::Type::CursorPos};
+			for(uint32_t i = 0; i < eventCount; ++i) {
+				ev.cursorPos = {static_cast<float>(i), static_cast<float>(i), 0.f, 0.f};
+				window->InjectEvent(ev);
+			}
+			pragma::platform::poll_events();
+		}));
+		window->SetInputCoalescingEnabled(false);
+		if(keyCount == 0)
+			std::cerr << "No events were dispatched!" << std::endl;
+	}
+
+	for(auto [axisCount, buttonCount] : {std::pair<int32_t, int32_t> {6, 16}, std::pair<int32_t, int32_t> {32, 128}}) {
+		auto joystick = pragma::platform::Joystick::Create(0);
+		uint64_t eventCount = 0;
+		joystick->SetAxisCallback([&eventCount](uint32_t, float, float) { ++eventCount; });
+		joystick->SetButtonCallback([&eventCount](uint32_t, pragma::platform::KeyState, pragma::platform::KeyState) { ++eventCount; });
+		std::array<std::vector<float>, 2> axes {std::vector<float>(axisCount, 0.f), std::vector<float>(axisCount, 0.f)};
+		std::array<std::vector<unsigned char>, 2> buttons {std::vector<unsigned char>(buttonCount, 0), std::vector<unsigned char>(buttonCount, 0)};
+		// Alternate between a resting state and a state where every fourth axis and button is active
+		for(int32_t i = 0; i < axisCount; i += 4)
+			axes[1][i] = 0.75f;
+		for(int32_t i = 0; i < buttonCount; i += 4)
+			buttons[1][i] = 1;
+		uint32_t frame = 0;
+		results.push_back(run_benchmark(std::format("joystick_poll/{}x{}", axisCount, buttonCount), iterations, 1, [&]() {
+			auto &curAxes = axes[frame % 2];
+			auto &curButtons = buttons[frame % 2];
+			joystick->Poll(curAxes.data(), axisCount, curButtons.data(), buttonCount);
+			++frame;
+		}));
+	}
+
+	results.push_back(run_benchmark("monitor_query", iterations, 1, []() {
+		auto &monitors = pragma::platform::get_monitors();
+		for(auto &monitor : monitors) {
+			monitor.GetVideoMode();
+			monitor.FindVideoMode({1920, 1080}, 60);
+		}
+	}));
+
+	{
+		std::vector<unsigned char> pixels(32 * 32 * 4, 255);
+		results.push_back(run_benchmark("cursor_create", std::max(iterations / 10, 1u), 1, [&pixels]() { pragma::platform::Cursor::Create(32, 32, pixels.data()); }));
+		results.push_back(run_benchmark("cursor_get_or_create", iterations, 1, [&pixels]() { pragma::platform::Cursor::GetOrCreate(32, 32, pixels.data()); }));
+		results.push_back(run_benchmark("standard_cursor", iterations, 1, []() { pragma::platform::Cursor::GetStandardCursor(pragma::platform::Cursor::Shape::Arrow); }));
+	}
+
+	{
+		std::vector<unsigned char> pixels(512 * 512 * 4, 128);
+		pragma::platform::ImageView image {pixels.data(), 512, 512, pragma::platform::PixelFormat::BGRA8, true};
+		results.push_back(run_benchmark("icon_set/512", std::max(iterations / 100, 1u), 1, [&image]() { pragma::platform::create_icon_set(image); }));
+	}
+
+	pragma::platform::terminate();
+
+	auto json = to_json(results);
+	if(outputFile.empty()) {
+		std::cout << json;
+		return 0;
+	}
+	std::ofstream f {outputFile};
+	if(!f) {
+		std::cerr << "Failed to write '" << outputFile << "'!" << std::endl;
+		return 1;
+	}
+	f << json;
+	return 0;
+}
@@ -0,0 +1,320 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+// Checks the SIMD code paths of the platform layer against straightforward scalar reference implementations.
+// The library uses the SSE2 code paths wherever they are available; Building it with IGLFW_DISABLE_SIMD checks the scalar code paths instead.
+// Runs on the null platform, so no display server is required.
+// Usage: iglfw_simd_check [--seed <seed>]
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import pragma.platform;
+
+namespace {
+	struct CheckContext {
+		std::mt19937 rng;
+		uint32_t checkCount = 0;
+		uint32_t failureCount = 0;
+	};
+
+	template<typename T>
+	bool check_equal(CheckContext &context, const std::string &name, std::span<const T> result, std::span<const T> expected)
+	{
+		++context.checkCount;
+		if(result.size() != expected.size()) {
+			++context.failureCount;
+			std::cerr << std::format("[{}] Size mismatch: {} (expected {})", name, result.size(), expected.size()) << std::endl;
+			return false;
+		}
+		auto it = std::mismatch(result.begin(), result.end(), expected.begin());
+		if(it.first == result.end())
+			return true;
+		++context.failureCount;
+		std::cerr << std::format("[{}] Mismatch at index {}: {} (expected {})", name, it.first - result.begin(), static_cast<int64_t>(*it.first), static_cast<int64_t>(*it.second)) << std::endl;
+		return false;
+	}
+
+	// UTF-8
+
+	void encode_utf8_reference(uint32_t cp, std::string &outText)
+	{
+		// Surrogates and codepoints outside of the Unicode range are replaced with U+FFFD
+		if(cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+			cp = 0xFFFD;
+		if(cp < 0x80)
+			outText += static_cast<char>(cp);
+		else if(cp < 0x800) {
+			outText += static_cast<char>(0xC0 | (cp >> 6));
+			outText += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else if(cp < 0x10000) {
+			outText += static_cast<char>(0xE0 | (cp >> 12));
+			outText += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			outText += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		else {
+			outText += static_cast<char>(0xF0 | (cp >> 18));
+			outText += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			outText += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			outText += static_cast<char>(0x80 | (cp & 0x3F));
+		}
+	}
+
+	// Encoded by the library through text input batching, which encodes all characters of a batch at once
+	std::string encode_utf8(pragma::platform::Window &window, std::span<const uint32_t> codepoints)
+	{
+		std::string text;
+		window.SetTextInputCallback([&text](pragma::platform::Window &, std::string_view str) { text += str; });
+		window.SetTextInputBatchingEnabled(true);
+		pragma::platform::InputEvent ev {pragma::platform::InputEvent::Type::Char};
+		for(auto cp : codepoints) {
+			ev.character = {cp, pragma::platform::Modifier::None};
+			window.InjectEvent(ev);
+		}
+		// Flushes the batch
+		window.SetTextInputBatchingEnabled(false);
+		window.SetTextInputCallback(nullptr);
+		return text;
+	}
+
+	void check_utf8(CheckContext &context, pragma::platform::Window &window)
+	{
+		auto check = [&context, &window](const std::string &name, std::span<const uint32_t> codepoints) {
+			std::string expected;
+			for(auto cp : codepoints)
+				encode_utf8_reference(cp, expected);
+			auto result = encode_utf8(window, codepoints);
+			check_equal<char>(context, "encode_utf8/" + name, result, expected);
+		};
+		constexpr std::array<uint32_t, 16> specialCodepoints {0x0, 0x7F, 0x80, 0x7FF, 0x800, 0xD7FF, 0xD800, 0xDBFF, 0xDC00, 0xDFFF, 0xE000, 0xFFFD, 0xFFFF, 0x10000, 0x10FFFF, 0x110000};
+		// The SIMD path processes blocks of eight codepoints, so a single non-ASCII codepoint is moved across all positions
+		// of two blocks, with lengths that don't end on a block boundary
+		for(auto special : specialCodepoints) {
+			for(size_t length : {1, 7, 8, 9, 15, 16, 17}) {
+				for(size_t pos = 0; pos < length; ++pos) {
+					std::vector<uint32_t> codepoints(length, 'a');
+					codepoints[pos] = special;
+					check(std::format("U+{:X}/{}/{}", special, length, pos), codepoints);
+				}
+			}
+		}
+		constexpr std::array<uint32_t, 4> invalidCodepoints {0x110000, 0x7FFFFFFF, 0x80000000, std::numeric_limits<uint32_t>::max()};
+		for(auto cp : invalidCodepoints) {
+			std::vector<uint32_t> codepoints(16, cp);
+			check(std::format("invalid/{:X}", cp), codepoints);
+		}
+		// Random mixed runs of ASCII and non-ASCII text
+		std::uniform_int_distribution<uint32_t> asciiDist {0, 0x7F};
+		std::uniform_int_distribution<uint32_t> codepointDist {0x80, 0x11FFFF};
+		std::uniform_int_distribution<uint32_t> runDist {1, 20};
+		for(uint32_t i = 0; i < 200; ++i) {
+			std::vector<uint32_t> codepoints;
+			auto length = std::uniform_int_distribution<size_t> {0, 256}(context.rng);
+			auto ascii = true;
+			while(codepoints.size() < length) {
+				auto run = std::min<size_t>(runDist(context.rng), length - codepoints.size());
+				for(size_t j = 0; j < run; ++j)
+					codepoints.push_back(ascii ? asciiDist(context.rng) : codepointDist(context.rng));
+				ascii = !ascii;
+			}
+			check(std::format("random/{}", i), codepoints);
+		}
+	}
+
+	// Gamma ramp
+
+	std::vector<uint16_t> generate_gamma_ramp_reference(size_t size, float gamma, float brightness, float contrast)
+	{
+		std::vector<uint16_t> ramp(size);
+		if(!(gamma > 0.f) || !std::isfinite(gamma))
+			gamma = 1.f;
+		auto exponent = 1.f / gamma;
+		auto scale = (size > 1) ? 1.f / static_cast<float>(size - 1) : 0.f;
+		auto mul = contrast * 65535.f;
+		auto add = ((0.5f - 0.5f * contrast) + brightness) * 65535.f + 0.5f;
+		for(size_t i = 0; i < size; ++i) {
+			auto v = (exponent == 1.f) ? static_cast<float>(i) * scale : std::pow(static_cast<float>(i) * scale, exponent);
+			ramp[i] = static_cast<uint16_t>(std::clamp(v * mul + add, 0.f, 65535.f));
+		}
+		return ramp;
+	}
+
+	void check_gamma_ramp(CheckContext &context)
+	{
+		for(size_t size : {1, 2, 7, 8, 9, 15, 16, 17, 256, 1024}) {
+			for(auto gamma : {1.f, 2.2f, 0.5f, 0.f, std::numeric_limits<float>::quiet_NaN()}) {
+				for(auto brightness : {0.f, 0.25f, -0.5f}) {
+					for(auto contrast : {1.f, 1.5f, 0.5f, 4.f}) {
+						std::vector<uint16_t> result(size);
+						pragma::platform::generate_gamma_ramp(result, gamma, brightness, contrast);
+						auto expected = generate_gamma_ramp_reference(size, gamma, brightness, contrast);
+						check_equal<uint16_t>(context, std::format("generate_gamma_ramp/{}/{}/{}/{}", size, gamma, brightness, contrast), result, expected);
+					}
+				}
+			}
+		}
+	}
+
+	// Pixel conversion
+
+	void unpremultiply_reference(unsigned char *p)
+	{
+		auto factor = (p[3] != 0) ? 255.f / static_cast<float>(p[3]) : 0.f;
+		for(size_t c = 0; c < 3; ++c)
+			p[c] = static_cast<unsigned char>(std::min(static_cast<float>(p[c]) * factor + 0.5f, 255.f));
+	}
+
+	unsigned char convert_f32_reference(float v)
+	{
+		// NaN values are mapped to 0
+		v = (v > 0.f) ? v : 0.f;
+		v = (v < 1.f) ? v : 1.f;
+		return static_cast<unsigned char>(v * 255.f + 0.5f);
+	}
+
+	std::vector<unsigned char> convert_to_rgba8_reference(const pragma::platform::ImageView &image)
+	{
+		std::vector<unsigned char> result(static_cast<size_t>(image.width) * image.height * 4);
+		auto bytesPerPixel = (image.format == pragma::platform::PixelFormat::RGBA32F) ? sizeof(float) * 4 : 4;
+		auto pitch = (image.rowPitch != 0) ? image.rowPitch : image.width * bytesPerPixel;
+		for(uint32_t y = 0; y < image.height; ++y) {
+			auto *srcRow = static_cast<const unsigned char *>(image.data) + y * pitch;
+			for(uint32_t x = 0; x < image.width; ++x) {
+				auto *dst = result.data() + (static_cast<size_t>(y) * image.width + x) * 4;
+				switch(image.format) {
+				case pragma::platform::PixelFormat::RGBA8:
+					std::memcpy(dst, srcRow + x * 4, 4);
+					break;
+				case pragma::platform::PixelFormat::BGRA8:
+					{
+						auto *src = srcRow + x * 4;
+						dst[0] = src[2];
+						dst[1] = src[1];
+						dst[2] = src[0];
+						dst[3] = src[3];
+						break;
+					}
+				case pragma::platform::PixelFormat::RGBA32F:
+					for(size_t c = 0; c < 4; ++c) {
+						float v;
+						std::memcpy(&v, srcRow + x * bytesPerPixel + c * sizeof(float), sizeof(v));
+						dst[c] = convert_f32_reference(v);
+					}
+					break;
+				default:
+					break;
+				}
+				if(image.premultiplied)
+					unpremultiply_reference(dst);
+			}
+		}
+		return result;
+	}
+
+	void check_pixel_conversion(CheckContext &context)
+	{
+		std::uniform_int_distribution<uint32_t> byteDist {0, 255};
+		std::uniform_real_distribution<float> floatDist {-0.25f, 1.25f};
+		for(auto format : {pragma::platform::PixelFormat::RGBA8, pragma::platform::PixelFormat::BGRA8, pragma::platform::PixelFormat::RGBA32F}) {
+			for(auto premultiplied : {false, true}) {
+				// Widths that aren't a multiple of the SIMD block size exercise the scalar tails
+				for(uint32_t width : {1, 3, 4, 5, 16, 17, 63}) {
+					for(uint32_t height : {1, 3}) {
+						for(size_t padding : {0, 12}) {
+							auto bytesPerPixel = (format == pragma::platform::PixelFormat::RGBA32F) ? sizeof(float) * 4 : 4;
+							auto pitch = width * bytesPerPixel + padding;
+							std::vector<unsigned char> data(pitch * height);
+							if(format == pragma::platform::PixelFormat::RGBA32F) {
+								for(size_t i = 0; i + sizeof(float) <= data.size(); i += sizeof(float)) {
+									auto v = floatDist(context.rng);
+									// Include the edge cases of the conversion
+									switch(byteDist(context.rng) % 16) {
+									case 0:
+										v = std::numeric_limits<float>::quiet_NaN();
+										break;
+									case 1:
+										v = 0.f;
+										break;
+									case 2:
+										v = 1.f;
+										break;
+									case 3:
+										v = std::numeric_limits<float>::infinity();
+										break;
+									default:
+										break;
+									}
+									std::memcpy(data.data() + i, &v, sizeof(v));
+								}
+							}
+							else {
+								for(size_t i = 0; i < data.size(); ++i)
+									data[i] = static_cast<unsigned char>(byteDist(context.rng));
+								// Random premultiplied pixels already include color values that exceed the alpha value, but rarely a zero alpha
+								for(size_t i = 3; i < data.size(); i += 4 * 5)
+									data[i] = 0;
+							}
+							pragma::platform::ImageView image {data.data(), width, height, format, premultiplied, padding > 0 ? pitch : 0};
+							auto result = pragma::platform::convert_to_rgba8(image);
+							auto expected = convert_to_rgba8_reference(image);
+							check_equal<unsigned char>(context, std::format("convert_to_rgba8/{}/{}/{}x{}/{}", static_cast<uint32_t>(format), premultiplied, width, height, padding), result.pixels, expected);
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	uint32_t seed = 0;
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--seed" && i + 1 < argc)
+			seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+	}
+
+	pragma::platform::InitInfo initInfo {};
+	initInfo.headless = true;
+	if(auto res = pragma::platform::initialize(initInfo); !res) {
+		std::cerr << "Failed to initialize platform: " << res.error() << std::endl;
+		return 1;
+	}
+
+	CheckContext context {std::mt19937 {seed}};
+	{
+		pragma::platform::WindowCreationInfo info {};
+		info.title = "iglfw_simd_check";
+		info.width = 320;
+		info.height = 240;
+		info.flags = pragma::platform::WindowCreationInfo::Flags::Windowless;
+		auto window = pragma::platform::Window::Create(info);
+		if(!window) {
+			std::cerr << "Failed to create window: " << window.error() << std::endl;
+			pragma::platform::terminate();
+			return 1;
+		}
+		check_utf8(context, **window);
+	}
+	check_gamma_ramp(context);
+	check_pixel_conversion(context);
+
+	pragma::platform::terminate();
+
+	std::cerr << std::format("{} of {} checks failed", context.failureCount, context.checkCount) << std::endl;
+	return (context.failureCount == 0) ? 0 : 1;
+}
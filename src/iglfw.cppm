@@ -4,7 +4,21 @@
 export module pragma.platform;
 export import :cursor;
 export import :core;
+export import :drop;
+export import :frame_pacer;
+export import :gamepad;
+export import :image;
+export import :input_channel;
+export import :input_event;
+export import :input_recording;
+export import :input_replay;
+export import :input_state;
+export import :input_statistics;
 export import :joystick;
+export import :joystick_backend;
 export import :keys;
+export import :listener;
 export import :monitor;
+export import :text_input;
+export import :timer;
 export import :window;
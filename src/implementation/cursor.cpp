@@ -7,6 +7,8 @@ module;
 
 module pragma.platform;
 
+import :image;
+
 using namespace pragma::platform;
 
 Cursor::Cursor(GLFWcursor *cursor) : m_handle(pragma::util::create_handle<Cursor>(this)), m_cursor(cursor) {}
@@ -25,25 +27,141 @@ const GLFWcursor *Cursor::GetGLFWCursor() const { return m_cursor; }
 
 ////////////////////////
 
-std::unique_ptr<Cursor> Cursor::Create(uint32_t width, uint32_t height, unsigned char *data, const Vector2i &hotSpot)
+std::unique_ptr<Cursor> Cursor::Create(uint32_t width, uint32_t height, const unsigned char *data, const Vector2i &hotSpot)
 {
 	GLFWimage image {};
 	image.width = width;
 	image.height = height;
-	image.pixels = data;
+	image.pixels = const_cast<unsigned char *>(data); // GLFW does not modify the image
 
 	auto *cursor = glfwCreateCursor(&image, hotSpot.x, hotSpot.y);
 	return std::unique_ptr<Cursor>(new Cursor(cursor));
 }
 
+namespace {
+	struct CursorCacheEntry {
+		uint64_t hash = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		Vector2i hotSpot {};
+		// Kept to rule out hash collisions
+		std::vector<unsigned char> pixels;
+		std::weak_ptr<Cursor> cursor;
+	};
+	std::vector<CursorCacheEntry> g_cursorCache;
+	std::array<std::unique_ptr<Cursor>, Cursor::STANDARD_SHAPE_COUNT> g_standardCursors;
+
+	size_t get_standard_cursor_index(Cursor::Shape shape)
+	{
+		switch(shape) {
+		case Cursor::Shape::Default:
+			return 0;
+		case Cursor::Shape::Hidden:
+			return 1;
+		default:
+			break;
+		}
+		auto idx = static_cast<size_t>(math::to_integral(shape) - GLFW_ARROW_CURSOR) + 2;
+		return (idx < Cursor::STANDARD_SHAPE_COUNT) ? idx : 0;
+	}
+};
+
+std::shared_ptr<Cursor> Cursor::GetOrCreate(uint32_t width, uint32_t height, const unsigned char *data, const Vector2i &hotSpot)
+{
+	auto size = static_cast<size_t>(width) * height * 4;
+	auto hash = detail::hash_image_data(data, size);
+	std::erase_if(g_cursorCache, [](const CursorCacheEntry &entry) { return entry.cursor.expired(); });
+	for(auto &entry : g_cursorCache) {
+		if(entry.hash != hash || entry.width != width || entry.height != height || entry.hotSpot != hotSpot || !std::equal(entry.pixels.begin(), entry.pixels.end(), data))
+			continue;
+		return entry.cursor.lock();
+	}
+
+	GLFWimage image {};
+	image.width = width;
+	image.height = height;
+	image.pixels = const_cast<unsigned char *>(data); // GLFW does not modify the image
+	auto *glfwCursor = glfwCreateCursor(&image, hotSpot.x, hotSpot.y);
+	if(!glfwCursor)
+		return nullptr;
+	auto cursor = std::shared_ptr<Cursor>(new Cursor(glfwCursor));
+	g_cursorCache.push_back({hash, width, height, hotSpot, std::vector<unsigned char>(data, data + size), cursor});
+	return cursor;
+}
+
+std::shared_ptr<Cursor> Cursor::GetOrCreate(const ImageView &image, const Vector2i &hotSpot)
+{
+	if(image.format == PixelFormat::RGBA8 && !image.premultiplied && (image.rowPitch == 0 || image.rowPitch == image.width * 4))
+		return GetOrCreate(image.width, image.height, static_cast<const unsigned char *>(image.data), hotSpot);
+	auto rgba = convert_to_rgba8(image);
+	if(rgba.pixels.empty())
+		return nullptr;
+	return GetOrCreate(rgba.width, rgba.height, rgba.pixels.data(), hotSpot);
+}
+
 Cursor &Cursor::GetStandardCursor(Shape shape)
 {
-	static std::unordered_map<Shape, std::unique_ptr<Cursor>> g_standardCursors;
-	auto it = g_standardCursors.find(shape);
-	if(it == g_standardCursors.end()) {
-		auto *glfwCursor = glfwCreateStandardCursor(static_cast<int>(shape));
-		std::unique_ptr<Cursor> cursor {new Cursor(glfwCursor)};
-		it = g_standardCursors.insert(std::make_pair(shape, std::move(cursor))).first;
+	auto &cursor = g_standardCursors[get_standard_cursor_index(shape)];
+	if(!cursor) {
+		// Default and Hidden have no GLFW shape; Their cursor is nullptr, which resets the window to the default cursor
+		auto *glfwCursor = (shape != Shape::Default && shape != Shape::Hidden) ? glfwCreateStandardCursor(static_cast<int>(shape)) : nullptr;
+		cursor = std::unique_ptr<Cursor> {new Cursor(glfwCursor)};
 	}
-	return *it->second;
+	return *cursor;
+}
+
+void Cursor::PreloadStandardCursors()
+{
+	GetStandardCursor(Shape::Default);
+	GetStandardCursor(Shape::Hidden);
+	for(auto shape = GLFW_ARROW_CURSOR; shape <= GLFW_NOT_ALLOWED_CURSOR; ++shape)
+		GetStandardCursor(static_cast<Shape>(shape));
+}
+
+void pragma::platform::detail::clear_cursor_caches()
+{
+	for(auto &cursor : g_standardCursors)
+		cursor = nullptr;
+	g_cursorCache.clear();
+}
+
+////////////////////////
+
+std::shared_ptr<AnimatedCursor> AnimatedCursor::Create(std::vector<Frame> frames)
+{
+	if(frames.empty())
+		return nullptr;
+	for(auto &frame : frames) {
+		if(!frame.cursor || !(frame.duration > 0.0))
+			return nullptr;
+	}
+	return std::shared_ptr<AnimatedCursor>(new AnimatedCursor(std::move(frames)));
+}
+
+std::shared_ptr<AnimatedCursor> AnimatedCursor::Create(uint32_t width, uint32_t height, std::span<const unsigned char *const> frameData, double frameDuration, const Vector2i &hotSpot)
+{
+	std::vector<Frame> frames;
+	frames.reserve(frameData.size());
+	for(auto *data : frameData)
+		frames.push_back({Cursor::GetOrCreate(width, height, data, hotSpot), frameDuration});
+	return Create(std::move(frames));
+}
+
+AnimatedCursor::AnimatedCursor(std::vector<Frame> &&frames) : m_frames(std::move(frames))
+{
+	m_frameEndTimes.reserve(m_frames.size());
+	auto t = 0.0;
+	for(auto &frame : m_frames) {
+		t += frame.duration;
+		m_frameEndTimes.push_back(t);
+	}
+}
+
+const std::vector<AnimatedCursor::Frame> &AnimatedCursor::GetFrames() const { return m_frames; }
+double AnimatedCursor::GetDuration() const { return m_frameEndTimes.back(); }
+size_t AnimatedCursor::GetFrameIndex(double t) const
+{
+	t = std::fmod(std::max(t, 0.0), GetDuration());
+	auto it = std::upper_bound(m_frameEndTimes.begin(), m_frameEndTimes.end(), t);
+	return std::min(static_cast<size_t>(it - m_frameEndTimes.begin()), m_frames.size() - 1);
 }
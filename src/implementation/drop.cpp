@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <fstream>
+
+module pragma.platform;
+
+import :drop;
+
+using namespace pragma::platform;
+
+DropPathList::DropPathList(const DropPathList &other) : m_buffer(other.m_buffer), m_offsets(other.m_offsets) { UpdateViews(); }
+DropPathList::DropPathList(DropPathList &&other) noexcept : m_buffer(std::move(other.m_buffer)), m_offsets(std::move(other.m_offsets))
+{
+	UpdateViews();
+	other.Clear();
+}
+DropPathList &DropPathList::operator=(const DropPathList &other)
+{
+	if(this == &other)
+		return *this;
+	m_buffer = other.m_buffer;
+	m_offsets = other.m_offsets;
+	UpdateViews();
+	return *this;
+}
+DropPathList &DropPathList::operator=(DropPathList &&other) noexcept
+{
+	if(this == &other)
+		return *this;
+	m_buffer = std::move(other.m_buffer);
+	m_offsets = std::move(other.m_offsets);
+	UpdateViews();
+	other.Clear();
+	return *this;
+}
+
+void DropPathList::Assign(int count, const char **paths)
+{
+	Clear();
+	Append(count, paths);
+}
+
+void DropPathList::Append(int count, const char **paths)
+{
+	size_t totalSize = m_buffer.size();
+	for(auto i = decltype(count) {0}; i < count; ++i)
+		totalSize += std::strlen(paths[i]) + 1;
+	m_buffer.reserve(totalSize);
+	m_offsets.reserve(m_offsets.size() + count);
+	for(auto i = decltype(count) {0}; i < count; ++i) {
+		m_offsets.push_back(static_cast<uint32_t>(m_buffer.size()));
+		m_buffer.append(paths[i]);
+		m_buffer.push_back('\0');
+	}
+	UpdateViews();
+}
+
+void DropPathList::Clear()
+{
+	m_buffer.clear();
+	m_offsets.clear();
+	m_views.clear();
+}
+
+void DropPathList::UpdateViews()
+{
+	// The buffer may have been reallocated, so all views have to be rebuilt
+	m_views.resize(m_offsets.size());
+	for(size_t i = 0; i < m_offsets.size(); ++i) {
+		auto end = (i + 1 < m_offsets.size()) ? m_offsets[i + 1] : m_buffer.size();
+		m_views[i] = std::string_view {m_buffer.data() + m_offsets[i], end - m_offsets[i] - 1};
+	}
+}
+
+std::span<const std::string_view> DropPathList::GetPaths() const { return m_views; }
+size_t DropPathList::GetCount() const { return m_views.size(); }
+bool DropPathList::IsEmpty() const { return m_views.empty(); }
+
+////////////////////////
+
+pragma::platform::detail::DropPrefetchJob::DropPrefetchJob(DropPathList &&paths, size_t prefetchSize) : m_paths(std::move(paths)), m_prefetchSize(prefetchSize)
+{
+	auto count = m_paths.GetCount();
+	m_files.resize(count);
+	m_data.resize(count);
+	m_remaining = static_cast<uint32_t>(count);
+}
+
+bool pragma::platform::detail::DropPrefetchJob::IsComplete() const { return m_remaining.load(std::memory_order_acquire) == 0; }
+std::span<const DroppedFile> pragma::platform::detail::DropPrefetchJob::GetFiles() const { return m_files; }
+const DropPathList &pragma::platform::detail::DropPrefetchJob::GetPaths() const { return m_paths; }
+
+bool pragma::platform::detail::DropPrefetchJob::ProcessNext()
+{
+	auto idx = m_nextIndex.fetch_add(1, std::memory_order_relaxed);
+	if(idx >= m_files.size())
+		return false;
+	auto &file = m_files[idx];
+	file.path = m_paths.GetPaths()[idx];
+	// Dropped files are native paths, which are usually outside of any mounted virtual file system, so they are accessed directly.
+	// GLFW provides them as UTF-8, which would otherwise be interpreted in the native narrow encoding on Windows.
+	std::filesystem::path path {std::u8string_view {reinterpret_cast<const char8_t *>(file.path.data()), file.path.size()}};
+	std::error_code ec;
+	auto status = std::filesystem::status(path, ec);
+	if(ec || status.type() == std::filesystem::file_type::not_found)
+		file.type = DroppedFile::Type::Missing;
+	else if(status.type() == std::filesystem::file_type::directory)
+		file.type = DroppedFile::Type::Directory;
+	else if(status.type() == std::filesystem::file_type::regular) {
+		file.type = DroppedFile::Type::File;
+		auto size = std::filesystem::file_size(path, ec);
+		file.size = ec ? 0 : size;
+		if(m_prefetchSize > 0 && file.size > 0) {
+			auto &data = m_data[idx];
+			data.resize(std::min<uint64_t>(file.size, m_prefetchSize));
+			std::ifstream f {path, std::ios::binary};
+			f.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+			data.resize(f ? data.size() : static_cast<size_t>(std::max<std::streamsize>(f.gcount(), 0)));
+			file.prefetchedData = data;
+		}
+	}
+	else
+		file.type = DroppedFile::Type::Other;
+	if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		glfwPostEmptyEvent();
+	return true;
+}
+
+namespace {
+	class DropPrefetchPool {
+	  public:
+		~DropPrefetchPool() { Shutdown(); }
+		void Submit(const std::shared_ptr<detail::DropPrefetchJob> &job)
+		{
+			{
+				std::scoped_lock lock {m_mutex};
+				if(m_threads.empty()) {
+					auto threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+					for(auto i = decltype(threadCount) {0}; i < threadCount; ++i)
+						m_threads.emplace_back([this]() { Run(); });
+				}
+				m_jobs.push_back(job);
+			}
+			m_condition.notify_all();
+		}
+		void Shutdown()
+		{
+			{
+				std::scoped_lock lock {m_mutex};
+				m_shutdown = true;
+			}
+			m_condition.notify_all();
+			for(auto &thread : m_threads)
+				thread.join();
+			m_threads.clear();
+			m_shutdown = false;
+		}
+	  private:
+		void Run()
+		{
+			for(;;) {
+				std::shared_ptr<detail::DropPrefetchJob> job;
+				{
+					std::unique_lock lock {m_mutex};
+					m_condition.wait(lock, [this]() { return m_shutdown || !m_jobs.empty(); });
+					if(m_jobs.empty())
+						return;
+					job = m_jobs.front();
+				}
+				// All workers share the files of the front job, the job is removed once all of its files have been claimed
+				if(!job->ProcessNext()) {
+					std::scoped_lock lock {m_mutex};
+					if(!m_jobs.empty() && m_jobs.front() == job)
+						m_jobs.pop_front();
+				}
+			}
+		}
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<std::shared_ptr<detail::DropPrefetchJob>> m_jobs;
+		std::vector<std::thread> m_threads;
+		bool m_shutdown = false;
+	};
+	// Created on demand and destroyed by terminate(). This is intentionally not a static object: If the application never calls terminate(),
+	// the worker threads would otherwise be joined by a static destructor, which can deadlock on Windows if it runs under the loader lock.
+	DropPrefetchPool *g_dropPrefetchPool = nullptr;
+};
+
+void pragma::platform::detail::submit_drop_prefetch_job(const std::shared_ptr<DropPrefetchJob> &job)
+{
+	if(job->GetPaths().IsEmpty())
+		return;
+	if(!g_dropPrefetchPool)
+		g_dropPrefetchPool = new DropPrefetchPool {};
+	g_dropPrefetchPool->Submit(job);
+}
+void pragma::platform::detail::shutdown_drop_prefetch_pool()
+{
+	delete g_dropPrefetchPool;
+	g_dropPrefetchPool = nullptr;
+}
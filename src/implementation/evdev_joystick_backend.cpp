@@ -0,0 +1,433 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+#include <GLFW/glfw3.h>
+
+module pragma.platform;
+
+import :joystick_backend;
+
+using namespace pragma::platform;
+
+#ifdef __linux__
+namespace {
+	constexpr size_t BITS_PER_LONG = sizeof(unsigned long) * 8;
+	constexpr size_t get_bit_word_count(size_t bitCount) { return (bitCount + BITS_PER_LONG - 1) / BITS_PER_LONG; }
+	bool is_bit_set(const unsigned long *bits, size_t bit) { return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1; }
+	double get_monotonic_time()
+	{
+		timespec ts {};
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1'000'000'000.0;
+	}
+
+	class EvdevJoystickBackend : public JoystickBackend {
+	  public:
+		// Has to be a power of two
+		static constexpr size_t RECORD_BUFFER_SIZE = 4'096;
+		static constexpr size_t CACHE_LINE_SIZE = 64;
+		static std::expected<std::unique_ptr<JoystickBackend>, std::string> Create();
+		virtual ~EvdevJoystickBackend() override;
+		virtual void Update() override;
+		virtual uint64_t GetDroppedSampleCount() const override;
+	  private:
+		EvdevJoystickBackend() = default;
+		// Accessed by the reader thread only
+		struct Reader {
+			int fd = -1;
+			std::string path;
+			int32_t joystickId = -1;
+			// Maps evdev codes to axis/button indices, -1 if the code is not supported by the device
+			std::array<int16_t, ABS_CNT> axisIndices;
+			std::array<int16_t, KEY_CNT> buttonIndices;
+			std::vector<input_absinfo> axisInfos;
+			// Set after SYN_DROPPED; Events are discarded until the next SYN_REPORT, after which the state is resynced
+			bool dropped = false;
+		};
+		// Device changes and samples share one queue, so they are applied in the order in which they occurred
+		struct Record {
+			enum class Type : uint8_t { Sample = 0, Connect, Disconnect };
+			JoystickSample sample;
+			Type type;
+		};
+
+		void Run();
+		void OpenDevice(const std::string &path);
+		void CloseDevice(Reader &reader);
+		void ReadDevice(Reader &reader);
+		// Pushes the current state of all axes and buttons, e.g. after the device was opened or events were dropped by the kernel
+		void SyncDeviceState(Reader &reader, double time);
+		void PushSample(const Reader &reader, JoystickSample::Type type, uint32_t index, float value, double time);
+		bool PushRecord(const Record &record, bool wait);
+
+		int m_epollFd = -1;
+		int m_wakeFd = -1;
+		int m_inotifyFd = -1;
+		// Offset from CLOCK_MONOTONIC to the get_time() timebase
+		double m_timeOffset = 0.0;
+		std::atomic<bool> m_running = false;
+		std::thread m_thread;
+
+		std::vector<std::unique_ptr<Reader>> m_readers;
+		// Readers that have been closed while processing a batch of epoll events. They're only destroyed after the batch, since
+		// later events of the same batch may still point to them.
+		std::vector<std::unique_ptr<Reader>> m_closedReaders;
+		std::array<bool, SLOT_COUNT> m_usedSlots {};
+
+		std::unique_ptr<Record[]> m_records;
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writeIndex = 0;
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readIndex = 0;
+		alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_droppedSampleCount = 0;
+
+		// Device infos for connect records; devices are connected rarely enough that a mutex is fine here
+		std::mutex m_deviceInfoMutex;
+		std::deque<JoystickDeviceInfo> m_deviceInfos;
+	};
+};
+
+std::expected<std::unique_ptr<JoystickBackend>, std::string> EvdevJoystickBackend::Create()
+{
+	auto backend = std::unique_ptr<EvdevJoystickBackend>(new EvdevJoystickBackend());
+	backend->m_records = std::make_unique<Record[]>(RECORD_BUFFER_SIZE);
+	backend->m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(backend->m_epollFd == -1)
+		return std::unexpected {std::format("Failed to create epoll instance: {}", strerror(errno))};
+	backend->m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(backend->m_wakeFd == -1)
+		return std::unexpected {std::format("Failed to create eventfd: {}", strerror(errno))};
+	// Events are identified by data.ptr: nullptr for the wake fd, the inotify fd or the Reader of a device
+	epoll_event ev {};
+	ev.events = EPOLLIN;
+	ev.data.ptr = nullptr;
+	epoll_ctl(backend->m_epollFd, EPOLL_CTL_ADD, backend->m_wakeFd, &ev);
+
+	// Hotplugging is optional; without it only devices that are present when the backend is created are available
+	backend->m_inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if(backend->m_inotifyFd != -1) {
+		if(inotify_add_watch(backend->m_inotifyFd, "/dev/input", IN_CREATE | IN_ATTRIB | IN_DELETE) != -1) {
+			ev.data.ptr = &backend->m_inotifyFd;
+			epoll_ctl(backend->m_epollFd, EPOLL_CTL_ADD, backend->m_inotifyFd, &ev);
+		}
+		else {
+			close(backend->m_inotifyFd);
+			backend->m_inotifyFd = -1;
+		}
+	}
+
+	backend->m_timeOffset = get_time() - get_monotonic_time();
+	backend->m_running = true;
+	backend->m_thread = std::thread {[backend = backend.get()]() { backend->Run(); }};
+	return backend;
+}
+
+EvdevJoystickBackend::~EvdevJoystickBackend()
+{
+	if(m_thread.joinable()) {
+		m_running = false;
+		uint64_t value = 1;
+		[[maybe_unused]] auto n = write(m_wakeFd, &value, sizeof(value));
+		m_thread.join();
+	}
+	for(auto &reader : m_readers)
+		close(reader->fd);
+	if(m_inotifyFd != -1)
+		close(m_inotifyFd);
+	if(m_wakeFd != -1)
+		close(m_wakeFd);
+	if(m_epollFd != -1)
+		close(m_epollFd);
+}
+
+void EvdevJoystickBackend::Update()
+{
+	ClearSamples();
+	auto readIdx = m_readIndex.load(std::memory_order_relaxed);
+	auto writeIdx = m_writeIndex.load(std::memory_order_acquire);
+	for(; readIdx != writeIdx; ++readIdx) {
+		auto &record = m_records[readIdx & (RECORD_BUFFER_SIZE - 1)];
+		switch(record.type) {
+		case Record::Type::Sample:
+			ApplySample(record.sample);
+			break;
+		case Record::Type::Connect:
+			{
+				JoystickDeviceInfo info;
+				{
+					std::scoped_lock lock {m_deviceInfoMutex};
+					info = std::move(m_deviceInfos.front());
+					m_deviceInfos.pop_front();
+				}
+				ConnectDevice(record.sample.joystickId, info);
+				break;
+			}
+		case Record::Type::Disconnect:
+			DisconnectDevice(record.sample.joystickId);
+			break;
+		}
+	}
+	m_readIndex.store(writeIdx, std::memory_order_release);
+}
+
+uint64_t EvdevJoystickBackend::GetDroppedSampleCount() const { return m_droppedSampleCount.load(std::memory_order_relaxed); }
+
+bool EvdevJoystickBackend::PushRecord(const Record &record, bool wait)
+{
+	auto writeIdx = m_writeIndex.load(std::memory_order_relaxed);
+	while(writeIdx - m_readIndex.load(std::memory_order_acquire) >= RECORD_BUFFER_SIZE) {
+		// Samples are dropped if the main thread doesn't keep up, but device changes must not be lost
+		if(!wait || !m_running.load(std::memory_order_relaxed)) {
+			m_droppedSampleCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds {1});
+	}
+	m_records[writeIdx & (RECORD_BUFFER_SIZE - 1)] = record;
+	m_writeIndex.store(writeIdx + 1, std::memory_order_release);
+	return true;
+}
+
+void EvdevJoystickBackend::PushSample(const Reader &reader, JoystickSample::Type type, uint32_t index, float value, double time) { PushRecord({{time, reader.joystickId, index, value, type}, Record::Type::Sample}, false); }
+
+void EvdevJoystickBackend::OpenDevice(const std::string &path)
+{
+	for(auto &reader : m_readers) {
+		if(reader->path == path)
+			return;
+	}
+	auto it = std::find(m_usedSlots.begin(), m_usedSlots.end(), false);
+	if(it == m_usedSlots.end())
+		return;
+	auto fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if(fd == -1)
+		return;
+
+	std::array<unsigned long, get_bit_word_count(EV_CNT)> evBits {};
+	std::array<unsigned long, get_bit_word_count(KEY_CNT)> keyBits {};
+	std::array<unsigned long, get_bit_word_count(ABS_CNT)> absBits {};
+	if(ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits.data()) < 0 || ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits.data()) < 0 || ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits.data()) < 0) {
+		close(fd);
+		return;
+	}
+	// Same criteria as GLFW: Anything with buttons and absolute axes is considered a joystick
+	if(!is_bit_set(evBits.data(), EV_KEY) || !is_bit_set(evBits.data(), EV_ABS)) {
+		close(fd);
+		return;
+	}
+
+	auto reader = std::make_unique<Reader>();
+	reader->fd = fd;
+	reader->path = path;
+	reader->joystickId = static_cast<int32_t>(it - m_usedSlots.begin());
+	reader->axisIndices.fill(-1);
+	reader->buttonIndices.fill(-1);
+
+	JoystickDeviceInfo info;
+	std::array<char, 256> name {};
+	if(ioctl(fd, EVIOCGNAME(name.size() - 1), name.data()) >= 0)
+		info.name = name.data();
+	input_id id {};
+	if(ioctl(fd, EVIOCGID, &id) >= 0)
+		info.guid = std::format("{:02x}{:02x}0000{:02x}{:02x}0000{:02x}{:02x}0000{:02x}{:02x}0000", id.bustype & 0xff, id.bustype >> 8, id.vendor & 0xff, id.vendor >> 8, id.product & 0xff, id.product >> 8, id.version & 0xff, id.version >> 8);
+
+	// Buttons are ordered like in GLFW, starting with the joystick/gamepad button range
+	for(uint32_t code = BTN_MISC; code < KEY_CNT; ++code) {
+		if(is_bit_set(keyBits.data(), code))
+			reader->buttonIndices[code] = static_cast<int16_t>(info.buttonCount++);
+	}
+	for(uint32_t code = 0; code < BTN_MISC; ++code) {
+		if(is_bit_set(keyBits.data(), code))
+			reader->buttonIndices[code] = static_cast<int16_t>(info.buttonCount++);
+	}
+	for(uint32_t code = 0; code < ABS_CNT; ++code) {
+		if(!is_bit_set(absBits.data(), code))
+			continue;
+		input_absinfo absInfo {};
+		if(ioctl(fd, EVIOCGABS(code), &absInfo) < 0)
+			continue;
+		reader->axisIndices[code] = static_cast<int16_t>(info.axisCount++);
+		reader->axisInfos.push_back(absInfo);
+	}
+
+	// Timestamps have to be comparable with get_time()
+	int clockId = CLOCK_MONOTONIC;
+	ioctl(fd, EVIOCSCLOCKID, &clockId);
+
+	epoll_event ev {};
+	ev.events = EPOLLIN;
+	ev.data.ptr = reader.get();
+	if(epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		close(fd);
+		return;
+	}
+
+	{
+		std::scoped_lock lock {m_deviceInfoMutex};
+		m_deviceInfos.push_back(std::move(info));
+	}
+	*it = true;
+	PushRecord({{get_monotonic_time() + m_timeOffset, reader->joystickId}, Record::Type::Connect}, true);
+	SyncDeviceState(*reader, get_monotonic_time() + m_timeOffset);
+	m_readers.push_back(std::move(reader));
+}
+
+void EvdevJoystickBackend::CloseDevice(Reader &reader)
+{
+	epoll_ctl(m_epollFd, EPOLL_CTL_DEL, reader.fd, nullptr);
+	close(reader.fd);
+	reader.fd = -1;
+	m_usedSlots[reader.joystickId] = false;
+	PushRecord({{get_monotonic_time() + m_timeOffset, reader.joystickId}, Record::Type::Disconnect}, true);
+	auto it = std::find_if(m_readers.begin(), m_readers.end(), [&reader](const std::unique_ptr<Reader> &other) { return other.get() == &reader; });
+	if(it != m_readers.end()) {
+		m_closedReaders.push_back(std::move(*it));
+		m_readers.erase(it);
+	}
+}
+
+void EvdevJoystickBackend::SyncDeviceState(Reader &reader, double time)
+{
+	std::array<unsigned long, get_bit_word_count(KEY_CNT)> keyStates {};
+	if(ioctl(reader.fd, EVIOCGKEY(sizeof(keyStates)), keyStates.data()) >= 0) {
+		for(uint32_t code = 0; code < KEY_CNT; ++code) {
+			auto idx = reader.buttonIndices[code];
+			if(idx != -1)
+				PushSample(reader, JoystickSample::Type::Button, idx, is_bit_set(keyStates.data(), code) ? GLFW_PRESS : GLFW_RELEASE, time);
+		}
+	}
+	for(uint32_t code = 0; code < ABS_CNT; ++code) {
+		auto idx = reader.axisIndices[code];
+		if(idx == -1)
+			continue;
+		auto &absInfo = reader.axisInfos[idx];
+		if(ioctl(reader.fd, EVIOCGABS(code), &absInfo) < 0)
+			continue;
+		auto range = absInfo.maximum - absInfo.minimum;
+		auto value = (range != 0) ? (static_cast<float>(absInfo.value - absInfo.minimum) / static_cast<float>(range)) * 2.f - 1.f : 0.f;
+		PushSample(reader, JoystickSample::Type::Axis, idx, value, time);
+	}
+}
+
+void EvdevJoystickBackend::ReadDevice(Reader &reader)
+{
+	std::array<input_event, 64> events;
+	for(;;) {
+		auto n = read(reader.fd, events.data(), sizeof(events));
+		if(n < 0) {
+			if(errno == EAGAIN || errno == EINTR)
+				return;
+			// ENODEV if the device has been unplugged
+			CloseDevice(reader);
+			return;
+		}
+		auto count = static_cast<size_t>(n) / sizeof(input_event);
+		for(size_t i = 0; i < count; ++i) {
+			auto &ev = events[i];
+			auto time = static_cast<double>(ev.input_event_sec) + static_cast<double>(ev.input_event_usec) / 1'000'000.0 + m_timeOffset;
+			if(reader.dropped) {
+				if(ev.type == EV_SYN && ev.code == SYN_REPORT) {
+					reader.dropped = false;
+					SyncDeviceState(reader, time);
+				}
+				continue;
+			}
+			switch(ev.type) {
+			case EV_KEY:
+				{
+					if(ev.code >= KEY_CNT || reader.buttonIndices[ev.code] == -1)
+						break;
+					// Key repeat events (value 2) don't change the button state
+					if(ev.value == 2)
+						break;
+					PushSample(reader, JoystickSample::Type::Button, reader.buttonIndices[ev.code], (ev.value != 0) ? GLFW_PRESS : GLFW_RELEASE, time);
+					break;
+				}
+			case EV_ABS:
+				{
+					if(ev.code >= ABS_CNT || reader.axisIndices[ev.code] == -1)
+						break;
+					auto &absInfo = reader.axisInfos[reader.axisIndices[ev.code]];
+					auto range = absInfo.maximum - absInfo.minimum;
+					auto value = (range != 0) ? (static_cast<float>(ev.value - absInfo.minimum) / static_cast<float>(range)) * 2.f - 1.f : 0.f;
+					PushSample(reader, JoystickSample::Type::Axis, reader.axisIndices[ev.code], value, time);
+					break;
+				}
+			case EV_SYN:
+				// The kernel has dropped events, the events up to the next SYN_REPORT are incomplete
+				if(ev.code == SYN_DROPPED)
+					reader.dropped = true;
+				break;
+			}
+		}
+		if(count < events.size())
+			return;
+	}
+}
+
+void EvdevJoystickBackend::Run()
+{
+	std::error_code ec;
+	for(auto &entry : std::filesystem::directory_iterator {"/dev/input", ec}) {
+		auto name = entry.path().filename().string();
+		if(name.starts_with("event"))
+			OpenDevice(entry.path().string());
+	}
+
+	std::array<epoll_event, 16> events;
+	while(m_running.load(std::memory_order_relaxed)) {
+		auto n = epoll_wait(m_epollFd, events.data(), static_cast<int>(events.size()), -1);
+		if(n < 0) {
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		for(auto i = 0; i < n; ++i) {
+			auto *ptr = events[i].data.ptr;
+			if(!ptr)
+				continue;
+			if(ptr == &m_inotifyFd) {
+				alignas(inotify_event) std::array<char, 4'096> buffer;
+				auto len = read(m_inotifyFd, buffer.data(), buffer.size());
+				for(ssize_t offset = 0; len > 0 && offset < len;) {
+					auto *ev = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+					offset += sizeof(inotify_event) + ev->len;
+					if(ev->len == 0 || std::string_view {ev->name}.starts_with("event") == false)
+						continue;
+					auto path = std::string {"/dev/input/"} + ev->name;
+					// IN_ATTRIB is needed because udev may only grant access to the device after it has been created
+					if(ev->mask & (IN_CREATE | IN_ATTRIB))
+						OpenDevice(path);
+					else if(ev->mask & IN_DELETE) {
+						auto it = std::find_if(m_readers.begin(), m_readers.end(), [&path](const std::unique_ptr<Reader> &reader) { return reader->path == path; });
+						if(it != m_readers.end())
+							CloseDevice(**it);
+					}
+				}
+				continue;
+			}
+			auto &reader = *static_cast<Reader *>(ptr);
+			// The device may have been closed by an earlier event of the same batch
+			if(reader.fd != -1)
+				ReadDevice(reader);
+		}
+		m_closedReaders.clear();
+	}
+}
+
+std::expected<std::unique_ptr<JoystickBackend>, std::string> pragma::platform::create_evdev_joystick_backend() { return EvdevJoystickBackend::Create(); }
+#else
+std::expected<std::unique_ptr<JoystickBackend>, std::string> pragma::platform::create_evdev_joystick_backend() { return std::unexpected {"The evdev joystick backend is only available on Linux!"}; }
+#endif
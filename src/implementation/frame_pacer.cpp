@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <GLFW/glfw3.h>
+
+module pragma.platform;
+
+import :core;
+import :frame_pacer;
+import :monitor;
+import :timer;
+
+using namespace pragma::platform;
+
+FramePacer::FramePacer(Window *window) { SetWindow(window); }
+void FramePacer::SetWindow(Window *window)
+{
+	m_window = window ? window->GetHandle() : WindowHandle {};
+	m_refreshRate = {};
+	m_refreshRateQueryTime = {};
+}
+Window *FramePacer::GetWindow() const { return m_window.IsValid() ? m_window.get() : nullptr; }
+void FramePacer::SetPolicy(const Policy &policy) { m_policy = policy; }
+const FramePacer::Policy &FramePacer::GetPolicy() const { return m_policy; }
+void FramePacer::SetFrameRateCap(std::optional<float> cap) { m_frameRateCap = cap; }
+std::optional<float> FramePacer::GetFrameRateCap() const { return m_frameRateCap; }
+void FramePacer::SetSpinDuration(TimerClock::duration duration) { m_spinDuration = std::max(duration, TimerClock::duration::zero()); }
+TimerClock::duration FramePacer::GetSpinDuration() const { return m_spinDuration; }
+
+std::optional<float> FramePacer::GetRefreshRate()
+{
+	auto *window = GetWindow();
+	auto now = TimerClock::now();
+	auto windowPos = window ? window->GetPos() : Vector2i {};
+	if(m_refreshRateQueryTime != TimerClock::time_point {} && windowPos == m_refreshRateWindowPos && now - m_refreshRateQueryTime < std::chrono::seconds(1))
+		return m_refreshRate;
+	m_refreshRateWindowPos = windowPos;
+	m_refreshRateQueryTime = now;
+
+	// Fullscreen windows are bound to their monitor, otherwise the monitor that contains the center of the window is used
+	std::optional<Monitor> monitor {};
+	if(window && window->GetMonitor())
+		monitor = *window->GetMonitor();
+	else if(window) {
+		auto center = windowPos + window->GetSize() / 2;
+		for(auto &m : get_monitors()) {
+			auto pos = m.GetPos();
+			auto mode = m.GetVideoMode();
+			if(center.x >= pos.x && center.y >= pos.y && center.x < pos.x + mode.width && center.y < pos.y + mode.height) {
+				monitor = m;
+				break;
+			}
+		}
+	}
+	if(!monitor)
+		monitor = get_primary_monitor();
+	m_refreshRate = {};
+	if(monitor->GetGLFWMonitor()) {
+		auto refreshRate = monitor->GetVideoMode().refreshRate;
+		if(refreshRate > 0)
+			m_refreshRate = static_cast<float>(refreshRate);
+	}
+	return m_refreshRate;
+}
+
+std::optional<float> FramePacer::GetTargetFrameRate()
+{
+	auto *window = GetWindow();
+	std::optional<float> frameRate {};
+	if(window && window->IsIconified())
+		frameRate = m_policy.iconifiedFrameRate;
+	else if(window && !window->IsFocused())
+		frameRate = m_policy.unfocusedFrameRate;
+	else
+		frameRate = m_policy.focusedFrameRate;
+	if(!frameRate)
+		frameRate = GetRefreshRate();
+	if(m_frameRateCap && (!frameRate || *frameRate > *m_frameRateCap))
+		frameRate = m_frameRateCap;
+	if(frameRate && *frameRate < 0.f)
+		frameRate = 0.f;
+	return frameRate;
+}
+
+bool FramePacer::WaitUntil(TimerClock::time_point t)
+{
+	for(;;) {
+		if(m_interrupted.load(std::memory_order_relaxed))
+			return false;
+		auto now = TimerClock::now();
+		if(now >= t)
+			return true;
+		auto waitEnd = t - m_spinDuration;
+		if(now >= waitEnd) {
+			std::this_thread::yield();
+			continue;
+		}
+		// Events received during the wait belong to the input frame of the following poll_events() call
+		detail::pump_events(std::chrono::duration<double> {waitEnd - now}.count());
+	}
+}
+
+void FramePacer::RecordFrame(TimerClock::time_point t, std::optional<TimerClock::duration> targetFrameTime)
+{
+	if(m_lastFrame) {
+		auto frameTime = std::chrono::duration_cast<std::chrono::nanoseconds>(t - *m_lastFrame);
+		m_frameTimes.Record(frameTime.count());
+		if(targetFrameTime) {
+			auto jitter = std::chrono::abs(frameTime - std::chrono::duration_cast<std::chrono::nanoseconds>(*targetFrameTime));
+			m_jitter.Record(jitter.count());
+		}
+	}
+	m_lastFrame = t;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+	auto frameRate = GetTargetFrameRate();
+	if(frameRate && *frameRate == 0.f) {
+		// No frames are produced in this state, so we just handle events and timers until it changes
+		m_frameDeadline = {};
+		while(!m_interrupted.load(std::memory_order_relaxed)) {
+			detail::pump_events({});
+			auto *window = GetWindow();
+			if(!window || window->ShouldClose())
+				break;
+			frameRate = GetTargetFrameRate();
+			if(!frameRate || *frameRate > 0.f)
+				break;
+		}
+		m_interrupted = false;
+		// The idle time is not a frame time
+		m_lastFrame = {};
+		RecordFrame(TimerClock::now(), {});
+		return;
+	}
+	if(!frameRate) {
+		m_frameDeadline = {};
+		m_interrupted = false;
+		RecordFrame(TimerClock::now(), {});
+		return;
+	}
+
+	auto frameTime = std::chrono::duration_cast<TimerClock::duration>(std::chrono::duration<double> {1.0 / *frameRate});
+	auto now = TimerClock::now();
+	// Frames are scheduled relative to the deadline of the previous frame rather than to the time it actually started,
+	// so that the waits don't accumulate drift. If we're already behind schedule, the schedule is reset instead of trying to catch up.
+	auto deadline = m_frameDeadline ? (*m_frameDeadline + frameTime) : now;
+	if(deadline < now) {
+		if(m_frameDeadline)
+			++m_missedFrames;
+		deadline = now;
+	}
+	else if(!WaitUntil(deadline))
+		deadline = TimerClock::now();
+	m_frameDeadline = deadline;
+	m_interrupted = false;
+	RecordFrame(TimerClock::now(), frameTime);
+}
+
+void FramePacer::Interrupt()
+{
+	m_interrupted = true;
+	glfwPostEmptyEvent();
+}
+
+FramePacer::Statistics FramePacer::GetStatistics() const
+{
+	Statistics stats {};
+	stats.frameTime = m_frameTimes.GetSnapshot();
+	stats.jitter = m_jitter.GetSnapshot();
+	stats.missedFrames = m_missedFrames;
+	return stats;
+}
+void FramePacer::ResetStatistics()
+{
+	m_frameTimes.Reset();
+	m_jitter.Reset();
+	m_missedFrames = 0;
+	m_lastFrame = {};
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+#include <GLFW/glfw3.h>
+
+module pragma.platform;
+
+import :gamepad;
+
+using namespace pragma::platform;
+
+namespace {
+	// All joystick slots fit into a single batch
+	constexpr size_t BATCH_SIZE = GLFW_JOYSTICK_LAST + 1;
+	using AxisBatch = std::array<float, BATCH_SIZE>;
+
+	void apply_stick_deadzone(float *xs, float *ys, size_t count, const GamepadConfig::Stick &stick)
+	{
+		auto inner = std::max(stick.innerDeadzone, 0.f);
+		auto outer = std::max(stick.outerDeadzone, inner + 0.001f);
+		auto range = outer - inner;
+		switch(stick.deadzoneMode) {
+		case GamepadConfig::DeadzoneMode::None:
+			break;
+		case GamepadConfig::DeadzoneMode::Axial:
+			for(size_t i = 0; i < count; ++i) {
+				xs[i] = std::copysign(std::clamp((std::abs(xs[i]) - inner) / range, 0.f, 1.f), xs[i]);
+				ys[i] = std::copysign(std::clamp((std::abs(ys[i]) - inner) / range, 0.f, 1.f), ys[i]);
+			}
+			break;
+		case GamepadConfig::DeadzoneMode::Radial:
+			for(size_t i = 0; i < count; ++i) {
+				auto mag = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+				auto factor = (mag <= inner) ? 0.f : ((mag >= outer) ? 1.f / mag : 1.f);
+				xs[i] *= factor;
+				ys[i] *= factor;
+			}
+			break;
+		case GamepadConfig::DeadzoneMode::ScaledRadial:
+			for(size_t i = 0; i < count; ++i) {
+				auto mag = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+				auto factor = (mag <= inner) ? 0.f : std::clamp((mag - inner) / range, 0.f, 1.f) / mag;
+				xs[i] *= factor;
+				ys[i] *= factor;
+			}
+			break;
+		}
+		static_assert(math::to_integral(GamepadConfig::DeadzoneMode::ScaledRadial) == 3, "Update this list when new deadzone modes have been added!");
+	}
+
+	void apply_trigger_deadzone(float *values, size_t count, float deadzone)
+	{
+		deadzone = std::clamp(deadzone, 0.f, 0.999f);
+		for(size_t i = 0; i < count; ++i)
+			values[i] = std::clamp(((values[i] + 1.f) * 0.5f - deadzone) / (1.f - deadzone), 0.f, 1.f);
+	}
+
+	void apply_response_curve(float *values, size_t count, const GamepadConfig::Axis &axis)
+	{
+		switch(axis.curve) {
+		case GamepadConfig::ResponseCurve::Linear:
+			break;
+		case GamepadConfig::ResponseCurve::Exponential:
+			for(size_t i = 0; i < count; ++i)
+				values[i] = std::copysign(std::pow(std::abs(values[i]), axis.exponent), values[i]);
+			break;
+		case GamepadConfig::ResponseCurve::Custom:
+			{
+				auto &lut = axis.lut;
+				if(lut.size() < 2)
+					break;
+				auto maxIdx = static_cast<float>(lut.size() - 1);
+				for(size_t i = 0; i < count; ++i) {
+					auto pos = std::min(std::abs(values[i]), 1.f) * maxIdx;
+					auto idx = std::min(static_cast<size_t>(pos), lut.size() - 2);
+					auto t = pos - static_cast<float>(idx);
+					values[i] = std::copysign(lut[idx] + (lut[idx + 1] - lut[idx]) * t, values[i]);
+				}
+				break;
+			}
+		}
+	}
+};
+
+void pragma::platform::detail::evaluate_gamepad_states(std::span<const GLFWgamepadstate> rawStates, const GamepadConfig &config, std::span<GamepadState> outStates)
+{
+	assert(rawStates.size() == outStates.size());
+	constexpr auto axisCount = GamepadState::AXIS_COUNT;
+	static_assert(axisCount == GLFW_GAMEPAD_AXIS_LAST + 1);
+	for(size_t offset = 0; offset < rawStates.size(); offset += BATCH_SIZE) {
+		auto count = std::min(rawStates.size() - offset, BATCH_SIZE);
+
+		// Transpose into one array per axis, so each processing step runs over all gamepads at once
+		std::array<AxisBatch, axisCount> axes;
+		for(size_t i = 0; i < count; ++i) {
+			auto &raw = rawStates[offset + i];
+			for(size_t axis = 0; axis < axisCount; ++axis)
+				axes[axis][i] = raw.axes[axis];
+		}
+
+		auto &leftStick = config.sticks[math::to_integral(GamepadStick::Left)];
+		auto &rightStick = config.sticks[math::to_integral(GamepadStick::Right)];
+		apply_stick_deadzone(axes[math::to_integral(GamepadAxis::LeftX)].data(), axes[math::to_integral(GamepadAxis::LeftY)].data(), count, leftStick);
+		apply_stick_deadzone(axes[math::to_integral(GamepadAxis::RightX)].data(), axes[math::to_integral(GamepadAxis::RightY)].data(), count, rightStick);
+		apply_trigger_deadzone(axes[math::to_integral(GamepadAxis::LeftTrigger)].data(), count, config.triggerDeadzone);
+		apply_trigger_deadzone(axes[math::to_integral(GamepadAxis::RightTrigger)].data(), count, config.triggerDeadzone);
+
+		for(size_t i = 0; i < count; ++i) {
+			auto &raw = rawStates[offset + i];
+			auto &out = outStates[offset + i];
+			uint32_t buttons = 0;
+			for(size_t button = 0; button <= GLFW_GAMEPAD_BUTTON_LAST; ++button) {
+				if(raw.buttons[button] == GLFW_PRESS)
+					buttons |= 1u << button;
+			}
+			// The trigger buttons use the trigger values before the response curve has been applied
+			if(axes[math::to_integral(GamepadAxis::LeftTrigger)][i] >= config.triggerThreshold)
+				buttons |= 1u << math::to_integral(GamepadButton::LeftTrigger);
+			if(axes[math::to_integral(GamepadAxis::RightTrigger)][i] >= config.triggerThreshold)
+				buttons |= 1u << math::to_integral(GamepadButton::RightTrigger);
+			out.buttons = buttons;
+		}
+
+		for(size_t axis = 0; axis < axisCount; ++axis) {
+			apply_response_curve(axes[axis].data(), count, config.axes[axis]);
+			for(size_t i = 0; i < count; ++i)
+				outStates[offset + i].axes[axis] = axes[axis][i];
+		}
+	}
+}
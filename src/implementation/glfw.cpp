@@ -12,11 +12,22 @@ module;
 module pragma.platform;
 
 import :joystick_handler;
+import :input_statistics;
+import :input_state;
+import :monitor;
+import :cursor;
+import :image;
+import :drop;
+import :timer;
+import :window;
 
 static bool g_initialized = false;
 static bool g_headless = false;
 static pragma::platform::JoystickHandler *s_joystickHandler = nullptr;
 
+static std::function<void(pragma::platform::Monitor, bool)> monitor_callback = nullptr;
+static std::function<void(const pragma::platform::MonitorTopologyChange &)> monitor_topology_callback = nullptr;
+
 static int platform_to_glfw_enum(pragma::platform::Platform platform);
 std::expected<void, std::string> pragma::platform::initialize(InitInfo initInfo)
 {
@@ -41,6 +52,14 @@ std::expected<void, std::string> pragma::platform::initialize(InitInfo initInfo)
 	}
 
 	g_initialized = true;
+	// Monitors may have been queried before initialization
+	detail::clear_monitor_cache();
+	glfwSetMonitorCallback([](GLFWmonitor *monitor, int ev) {
+		auto connected = (ev == GLFW_CONNECTED) ? true : false;
+		auto m = detail::on_monitor_event(monitor, connected);
+		if(monitor_callback)
+			monitor_callback(m, connected);
+	});
 #ifdef _WIN32
 	OleInitialize(nullptr);
 #endif
@@ -52,7 +71,14 @@ void pragma::platform::terminate()
 	if(g_initialized == false)
 		return;
 	set_joysticks_enabled(false);
+	detail::clear_cursor_caches();
+	detail::clear_icon_set_cache();
+	detail::clear_clipboard_cache();
+	detail::shutdown_drop_prefetch_pool();
+	detail::clear_timers();
 	glfwTerminate();
+	detail::clear_monitor_cache();
+	g_initialized = false;
 #ifdef _WIN32
 	OleUninitialize();
 #endif
@@ -106,27 +132,65 @@ void pragma::platform::get_version(int *major, int *minor, int *rev) { glfwGetVe
 
 std::string pragma::platform::get_version_string() { return glfwGetVersionString(); }
 
+void pragma::platform::detail::pump_events(std::optional<double> timeout)
+{
+	// Never block past the next timer, so that it is fired on time
+	if(auto deadline = get_next_timer_deadline()) {
+		auto timerTimeout = std::max(std::chrono::duration<double> {*deadline - TimerClock::now()}.count(), 0.0);
+		timeout = timeout ? std::min(*timeout, timerTimeout) : timerTimeout;
+	}
+	if(!timeout)
+		glfwWaitEvents();
+	else if(*timeout > 0.0)
+		glfwWaitEventsTimeout(*timeout);
+	else if(is_input_statistics_enabled()) {
+		// Only non-blocking calls are recorded, otherwise the statistics would mostly consist of idle time
+		auto t = std::chrono::steady_clock::now();
+		glfwPollEvents();
+		auto dt = std::chrono::steady_clock::now() - t;
+		record_poll_duration(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+	}
+	else
+		glfwPollEvents();
+	Window::PollWindows();
+	process_timers();
+
+	if(monitor_topology_callback) {
+		MonitorTopologyChange change {};
+		if(pop_monitor_topology_change(change))
+			monitor_topology_callback(change);
+	}
+}
+
 void pragma::platform::poll_events()
 {
-	glfwPollEvents();
-	for(auto *window : Window::GetWindows())
-		window->Poll();
+	detail::pump_events(0.0);
+	// Input that is received from here on (including during wait_events()) belongs to the next frame
+	detail::advance_input_frame();
 }
 void pragma::platform::poll_joystick_events()
 {
 	if(s_joystickHandler != nullptr)
 		s_joystickHandler->Poll();
 }
-void pragma::platform::wait_events() { glfwWaitEvents(); }
+void pragma::platform::wait_events()
+{
+	// Completes the current frame, so that applications that only call wait_events() don't accumulate input transitions
+	// forever. Input received during the wait belongs to the same frame as the input of a subsequent poll_events() call.
+	detail::advance_input_frame();
+	detail::pump_events({});
+}
 void pragma::platform::post_empty_events() { glfwPostEmptyEvent(); }
 double pragma::platform::get_time() { return glfwGetTime(); }
 void pragma::platform::set_time(double t) { glfwSetTime(t); }
 
-static std::function<void(pragma::platform::Monitor, bool)> monitor_callback = nullptr;
-void pragma::platform::set_monitor_callback(const std::function<void(Monitor, bool)> &callback)
+void pragma::platform::set_monitor_callback(const std::function<void(Monitor, bool)> &callback) { monitor_callback = callback; }
+void pragma::platform::set_monitor_topology_callback(const std::function<void(const MonitorTopologyChange &)> &callback)
 {
-	monitor_callback = callback;
-	glfwSetMonitorCallback([](GLFWmonitor *monitor, int ev) { monitor_callback(Monitor(monitor), (ev == GLFW_CONNECTED) ? true : false); });
+	monitor_topology_callback = callback;
+	// Discard changes that occurred before the callback was set
+	MonitorTopologyChange change {};
+	detail::pop_monitor_topology_change(change);
 }
 void pragma::platform::set_joystick_state_callback(const std::function<void(const Joystick &, bool)> &callback)
 {
@@ -150,6 +214,25 @@ void pragma::platform::set_joystick_axis_callback(const std::function<void(const
 		return;
 	s_joystickHandler->SetJoystickAxisCallback(callback);
 }
+void pragma::platform::set_joystick_axis_button_callback(const std::function<void(const Joystick &, uint32_t, KeyState, Modifier)> &callback)
+{
+	if(s_joystickHandler == nullptr)
+		return;
+	s_joystickHandler->SetJoystickAxisButtonCallback(callback);
+}
+void pragma::platform::set_joystick_axis_config(const std::optional<JoystickAxisConfig> &config)
+{
+	if(s_joystickHandler == nullptr)
+		return;
+	s_joystickHandler->SetAxisConfig(config);
+}
+
+void pragma::platform::set_joystick_input_recorder(const std::shared_ptr<InputRecorder> &recorder)
+{
+	if(s_joystickHandler == nullptr)
+		return;
+	s_joystickHandler->SetInputRecorder(recorder);
+}
 
 void pragma::platform::set_joysticks_enabled(bool b)
 {
@@ -167,10 +250,42 @@ void pragma::platform::set_joysticks_enabled(bool b)
 	s_joystickHandler = &JoystickHandler::GetInstance();
 }
 
+void pragma::platform::set_joystick_backend(std::unique_ptr<JoystickBackend> backend)
+{
+	if(s_joystickHandler == nullptr)
+		return;
+	s_joystickHandler->SetBackend(std::move(backend));
+}
+pragma::platform::JoystickBackend *pragma::platform::get_joystick_backend()
+{
+	if(s_joystickHandler == nullptr)
+		return nullptr;
+	return s_joystickHandler->GetBackend();
+}
+std::span<const pragma::platform::JoystickSample> pragma::platform::get_joystick_samples()
+{
+	if(s_joystickHandler == nullptr)
+		return {};
+	return s_joystickHandler->GetSamples();
+}
+
 static auto s_axisThreshold = 0.f;
 void pragma::platform::set_joystick_axis_threshold(float threshold) { s_axisThreshold = threshold; }
 float pragma::platform::get_joystick_axis_threshold() { return s_axisThreshold; }
 
+static auto s_gamepadStatesEnabled = false;
+static pragma::platform::GamepadConfig s_gamepadConfig {};
+void pragma::platform::set_gamepad_states_enabled(bool enabled) { s_gamepadStatesEnabled = enabled; }
+bool pragma::platform::are_gamepad_states_enabled() { return s_gamepadStatesEnabled; }
+void pragma::platform::set_gamepad_config(const GamepadConfig &config) { s_gamepadConfig = config; }
+const pragma::platform::GamepadConfig &pragma::platform::get_gamepad_config() { return s_gamepadConfig; }
+void pragma::platform::set_gamepad_button_callback(const std::function<void(const Joystick &, GamepadButton, KeyState, KeyState)> &callback)
+{
+	if(s_joystickHandler == nullptr)
+		return;
+	s_joystickHandler->SetGamepadButtonCallback(callback);
+}
+
 const std::vector<std::shared_ptr<pragma::platform::Joystick>> &pragma::platform::get_joysticks()
 {
 	if(s_joystickHandler == nullptr) {
@@ -180,40 +295,44 @@ const std::vector<std::shared_ptr<pragma::platform::Joystick>> &pragma::platform
 	return s_joystickHandler->GetJoysticks();
 }
 
+std::shared_ptr<pragma::platform::Joystick> pragma::platform::get_joystick(uint32_t joystickId)
+{
+	if(s_joystickHandler == nullptr)
+		return nullptr;
+	return s_joystickHandler->FindJoystick(static_cast<int32_t>(joystickId));
+}
 std::string pragma::platform::get_joystick_name(uint32_t joystickId)
 {
-	auto &joysticks = get_joysticks();
-	if(joystickId >= joysticks.size())
+	auto joystick = get_joystick(joystickId);
+	if(!joystick)
 		return "";
-	return joysticks.at(joystickId)->GetName();
+	return joystick->GetName();
 }
 const std::vector<float> &pragma::platform::get_joystick_axes(uint32_t joystickId)
 {
-	auto &joysticks = get_joysticks();
-	if(joystickId >= joysticks.size()) {
+	auto joystick = get_joystick(joystickId);
+	if(!joystick) {
 		static std::vector<float> r {};
 		return r;
 	}
-	return joysticks.at(joystickId)->GetAxes();
+	return joystick->GetAxes();
 }
 const std::vector<pragma::platform::KeyState> &pragma::platform::get_joystick_buttons(uint32_t joystickId)
 {
-	auto &joysticks = get_joysticks();
-	if(joystickId >= joysticks.size()) {
+	auto joystick = get_joystick(joystickId);
+	if(!joystick) {
 		static std::vector<KeyState> r {};
 		return r;
 	}
-	return joysticks.at(joystickId)->GetButtons();
+	return joystick->GetButtons();
 }
 
-pragma::platform::Monitor pragma::platform::get_primary_monitor() { return Monitor(glfwGetPrimaryMonitor()); }
-std::vector<pragma::platform::Monitor> pragma::platform::get_monitors()
+pragma::platform::Monitor pragma::platform::get_primary_monitor()
 {
-	std::vector<Monitor> r;
-	int count = 0;
-	auto *monitors = glfwGetMonitors(&count);
-	r.reserve(count);
-	for(auto i = decltype(count) {0}; i < count; ++i)
-		r.push_back(Monitor(monitors[i]));
-	return r;
+	// The primary monitor is always the first one
+	auto &monitors = detail::get_cached_monitors();
+	if(monitors.empty())
+		return Monitor(nullptr);
+	return monitors.front();
 }
+const std::vector<pragma::platform::Monitor> &pragma::platform::get_monitors() { return detail::get_cached_monitors(); }
@@ -8,6 +8,8 @@ module;
 module pragma.platform;
 
 import :joystick;
+import :gamepad;
+import :joystick_backend;
 import :joystick_handler;
 
 using namespace pragma::platform;
@@ -19,55 +21,114 @@ JoystickHandler &JoystickHandler::GetInstance()
 		s_joystickHandler = std::shared_ptr<JoystickHandler>(new JoystickHandler());
 	return *s_joystickHandler;
 }
+JoystickHandler *JoystickHandler::FindInstance() { return s_joystickHandler.get(); }
 void JoystickHandler::Release() { s_joystickHandler = nullptr; }
 
 JoystickHandler::JoystickHandler()
 {
-	m_joysticks.reserve(GLFW_JOYSTICK_LAST - GLFW_JOYSTICK_1 + 1);
+	m_joysticks.reserve(SLOT_COUNT);
 	for(auto i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; ++i) {
-		auto r = glfwJoystickPresent(i);
-		if(r == GLFW_FALSE)
-			return;
-		m_joysticks.push_back(Joystick::Create(i));
-		if(m_joystickStateCallback != nullptr)
-			m_joystickStateCallback(*m_joysticks.back(), JoystickState::Connected);
-		auto &joystick = m_joysticks.back();
-		auto *ptrJoystick = joystick.get();
-		joystick->SetButtonCallback([this, ptrJoystick](uint32_t button, KeyState oldState, KeyState newState) {
-			if(m_joystickButtonCallback == nullptr)
-				return;
-			m_joystickButtonCallback(*ptrJoystick, button, oldState, newState);
-		});
-		joystick->SetAxisCallback([this, ptrJoystick](uint32_t axis, float oldVal, float newVal) {
-			if(m_joystickAxisCallback == nullptr)
-				return;
-			m_joystickAxisCallback(*ptrJoystick, axis, oldVal, newVal);
-		});
+		if(glfwJoystickPresent(i) == GLFW_FALSE)
+			continue;
+		Connect(i);
 	}
 
 	glfwSetJoystickCallback([](int joystickId, int eventId) {
 		auto *handler = s_joystickHandler.get();
+		// GLFW joysticks are ignored while a custom backend is active
+		if(!handler || handler->m_backend)
+			return;
 		switch(eventId) {
 		case GLFW_CONNECTED:
-			handler->m_joysticks.push_back(Joystick::Create(joystickId));
-			if(handler->m_joystickStateCallback != nullptr)
-				handler->m_joystickStateCallback(*handler->m_joysticks.back(), JoystickState::Connected);
+			handler->Connect(joystickId);
 			break;
 		default:
-			auto it = std::find_if(handler->m_joysticks.begin(), handler->m_joysticks.end(), [joystickId](const std::shared_ptr<Joystick> &joystick) { return (joystick->GetJoystickId() == joystickId) ? true : false; });
-			if(it == handler->m_joysticks.end())
-				return;
-			if(handler->m_joystickStateCallback != nullptr)
-				handler->m_joystickStateCallback(*(*it), JoystickState::Disconnected);
+			handler->Disconnect(joystickId);
 			break;
 		}
 	});
 }
 
+void JoystickHandler::Connect(int32_t joystickId, const JoystickDeviceInfo *info)
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT)
+		return;
+	auto &slot = m_slots[joystickId];
+	if(slot.joystick)
+		Disconnect(joystickId);
+	slot.joystick = info ? Joystick::Create(joystickId, ++slot.generation, info->name, info->guid) : Joystick::Create(joystickId, ++slot.generation);
+	auto *ptrJoystick = slot.joystick.get();
+	ptrJoystick->SetButtonCallback([this, ptrJoystick](uint32_t button, KeyState oldState, KeyState newState) { DispatchButtonEvent(*ptrJoystick, button, oldState, newState); });
+	ptrJoystick->SetAxisCallback([this, ptrJoystick](uint32_t axis, float oldVal, float newVal) { DispatchAxisEvent(*ptrJoystick, axis, oldVal, newVal); });
+	ptrJoystick->SetAxisButtonCallback([this, ptrJoystick](uint32_t axis, KeyState state, Modifier mods) {
+		if(m_joystickAxisButtonCallback != nullptr)
+			m_joystickAxisButtonCallback(*ptrJoystick, axis, state, mods);
+	});
+	if(m_axisConfig)
+		ptrJoystick->SetAxisConfig(*m_axisConfig);
+	UpdateJoystickList();
+	if(m_joystickStateCallback != nullptr)
+		m_joystickStateCallback(*ptrJoystick, JoystickState::Connected);
+}
+
+void JoystickHandler::Disconnect(int32_t joystickId)
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT)
+		return;
+	auto &slot = m_slots[joystickId];
+	if(!slot.joystick)
+		return;
+	// Keep the joystick alive until the callback has completed
+	auto joystick = std::move(slot.joystick);
+	UpdateJoystickList();
+	if(m_joystickStateCallback != nullptr)
+		m_joystickStateCallback(*joystick, JoystickState::Disconnected);
+}
+
+void JoystickHandler::UpdateJoystickList()
+{
+	m_joysticks.clear();
+	for(auto &slot : m_slots) {
+		if(slot.joystick)
+			m_joysticks.push_back(slot.joystick);
+	}
+}
+
 JoystickHandler::~JoystickHandler() { glfwSetJoystickCallback(nullptr); }
 
+void JoystickHandler::SetBackend(std::unique_ptr<JoystickBackend> backend)
+{
+	for(int32_t i = 0; i < static_cast<int32_t>(SLOT_COUNT); ++i)
+		Disconnect(i);
+	m_backend = std::move(backend);
+	if(m_backend)
+		return; // Devices of the backend are picked up by the next Poll()
+	for(auto i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; ++i) {
+		if(glfwJoystickPresent(i) == GLFW_TRUE)
+			Connect(i);
+	}
+}
+JoystickBackend *JoystickHandler::GetBackend() { return m_backend.get(); }
+std::span<const JoystickSample> JoystickHandler::GetSamples() const
+{
+	if(!m_backend)
+		return {};
+	return m_backend->GetSamples();
+}
+
 void JoystickHandler::SetJoystickButtonCallback(const std::function<void(const Joystick &, uint32_t, KeyState, KeyState)> &callback) { m_joystickButtonCallback = callback; }
 void JoystickHandler::SetJoystickAxisCallback(const std::function<void(const Joystick &, uint32_t, float, float)> &callback) { m_joystickAxisCallback = callback; }
+void JoystickHandler::SetJoystickAxisButtonCallback(const std::function<void(const Joystick &, uint32_t, KeyState, Modifier)> &callback) { m_joystickAxisButtonCallback = callback; }
+void JoystickHandler::SetAxisConfig(const std::optional<JoystickAxisConfig> &config)
+{
+	m_axisConfig = config;
+	for(auto &joystick : m_joysticks) {
+		if(config)
+			joystick->SetAxisConfig(*config);
+		else
+			joystick->ClearAxisConfigs();
+	}
+}
 void JoystickHandler::SetJoystickStateCallback(const std::function<void(const Joystick &, JoystickState)> &callback)
 {
 	m_joystickStateCallback = callback;
@@ -77,9 +138,92 @@ void JoystickHandler::SetJoystickStateCallback(const std::function<void(const Jo
 		callback(*joystick, JoystickState::Connected);
 }
 const std::vector<std::shared_ptr<Joystick>> &JoystickHandler::GetJoysticks() const { return m_joysticks; }
+const std::shared_ptr<Joystick> &JoystickHandler::FindJoystick(int32_t joystickId) const
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT) {
+		static std::shared_ptr<Joystick> r {};
+		return r;
+	}
+	return m_slots[joystickId].joystick;
+}
+
+void JoystickHandler::SetInputRecorder(const std::shared_ptr<InputRecorder> &recorder) { m_inputRecorder = recorder; }
+void JoystickHandler::DispatchButtonEvent(const Joystick &joystick, uint32_t button, KeyState oldState, KeyState newState)
+{
+	if(m_inputRecorder)
+		m_inputRecorder->RecordJoystickButton(joystick.GetJoystickId(), button, oldState, newState, joystick.GetPollTime());
+	if(m_joystickButtonCallback == nullptr)
+		return;
+	m_joystickButtonCallback(joystick, button, oldState, newState);
+}
+void JoystickHandler::DispatchAxisEvent(const Joystick &joystick, uint32_t axis, float oldVal, float newVal)
+{
+	if(m_inputRecorder)
+		m_inputRecorder->RecordJoystickAxis(joystick.GetJoystickId(), axis, oldVal, newVal, joystick.GetPollTime());
+	if(m_joystickAxisCallback == nullptr)
+		return;
+	m_joystickAxisCallback(joystick, axis, oldVal, newVal);
+}
+
+void JoystickHandler::SetGamepadButtonCallback(const std::function<void(const Joystick &, GamepadButton, KeyState, KeyState)> &callback) { m_gamepadButtonCallback = callback; }
 
 void JoystickHandler::Poll()
 {
+	if(m_backend) {
+		PollBackend();
+		return;
+	}
 	for(auto &joystick : m_joysticks)
 		joystick->Poll();
+	if(are_gamepad_states_enabled())
+		PollGamepads();
+}
+
+void JoystickHandler::PollBackend()
+{
+	m_backend->Update();
+	static_assert(JoystickBackend::SLOT_COUNT == SLOT_COUNT);
+	for(int32_t i = 0; i < static_cast<int32_t>(SLOT_COUNT); ++i) {
+		auto *device = m_backend->FindDevice(i);
+		auto &joystick = m_slots[i].joystick;
+		if(!device) {
+			if(joystick)
+				Disconnect(i);
+			continue;
+		}
+		if(!joystick)
+			Connect(i, &device->info);
+		joystick->Poll(device->axes.data(), static_cast<int32_t>(device->axes.size()), device->buttons.data(), static_cast<int32_t>(device->buttons.size()));
+	}
+}
+
+void JoystickHandler::PollGamepads()
+{
+	m_gamepads.clear();
+	m_rawGamepadStates.clear();
+	for(auto &joystick : m_joysticks) {
+		GLFWgamepadstate state;
+		if(glfwGetGamepadState(joystick->GetJoystickId(), &state) == GLFW_FALSE)
+			continue;
+		m_gamepads.push_back(joystick.get());
+		m_rawGamepadStates.push_back(state);
+	}
+	m_gamepadStates.resize(m_rawGamepadStates.size());
+	detail::evaluate_gamepad_states(m_rawGamepadStates, get_gamepad_config(), m_gamepadStates);
+
+	for(size_t i = 0; i < m_gamepads.size(); ++i) {
+		auto &joystick = *m_gamepads[i];
+		auto oldButtons = joystick.GetGamepadState().buttons;
+		auto &newState = m_gamepadStates[i];
+		joystick.SetGamepadState(newState);
+		if(m_gamepadButtonCallback == nullptr)
+			continue;
+		auto changed = oldButtons ^ newState.buttons;
+		while(changed != 0) {
+			auto button = static_cast<uint32_t>(std::countr_zero(changed));
+			changed &= changed - 1;
+			auto isDown = (newState.buttons & (1u << button)) != 0;
+			m_gamepadButtonCallback(joystick, static_cast<GamepadButton>(button), isDown ? KeyState::Release : KeyState::Press, isDown ? KeyState::Press : KeyState::Release);
+		}
+	}
 }
@@ -9,26 +9,69 @@ module;
 export module pragma.platform:joystick_handler;
 
 import :joystick;
+import :gamepad;
+import :joystick_backend;
+import :input_recording;
 
 namespace pragma::platform {
 	class JoystickHandler {
 	  public:
 		static JoystickHandler &GetInstance();
+		// Returns nullptr if joysticks are disabled
+		static JoystickHandler *FindInstance();
 		static void Release();
 		~JoystickHandler();
 
 		enum class JoystickState : decltype(GLFW_CONNECTED) { Connected = GLFW_CONNECTED, Disconnected = GLFW_DISCONNECTED };
+		static constexpr size_t SLOT_COUNT = GLFW_JOYSTICK_LAST + 1;
 
 		void SetJoystickButtonCallback(const std::function<void(const Joystick &, uint32_t, KeyState, KeyState)> &callback);
 		void SetJoystickAxisCallback(const std::function<void(const Joystick &, uint32_t, float, float)> &callback);
 		void SetJoystickStateCallback(const std::function<void(const Joystick &, JoystickState)> &callback);
+		// Returns all connected joysticks, ordered by joystick id
 		const std::vector<std::shared_ptr<Joystick>> &GetJoysticks() const;
+		// Returns nullptr if no joystick is connected with the specified GLFW joystick id
+		const std::shared_ptr<Joystick> &FindJoystick(int32_t joystickId) const;
+		void SetInputRecorder(const std::shared_ptr<InputRecorder> &recorder);
+		void DispatchButtonEvent(const Joystick &joystick, uint32_t button, KeyState oldState, KeyState newState);
+		void DispatchAxisEvent(const Joystick &joystick, uint32_t axis, float oldVal, float newVal);
+		// If a backend is set, joysticks are sampled through it instead of GLFW
+		void SetBackend(std::unique_ptr<JoystickBackend> backend);
+		JoystickBackend *GetBackend();
+		std::span<const JoystickSample> GetSamples() const;
+		void SetJoystickAxisButtonCallback(const std::function<void(const Joystick &, uint32_t, KeyState, Modifier)> &callback);
+		// Applied to all connected joysticks and joysticks that are connected later
+		void SetAxisConfig(const std::optional<JoystickAxisConfig> &config);
+		void SetGamepadButtonCallback(const std::function<void(const Joystick &, GamepadButton, KeyState, KeyState)> &callback);
 		void Poll();
 	  private:
 		JoystickHandler();
+		// If info is nullptr, the joystick's name and GUID are queried from GLFW
+		void Connect(int32_t joystickId, const JoystickDeviceInfo *info = nullptr);
+		void Disconnect(int32_t joystickId);
+		void UpdateJoystickList();
+		void PollGamepads();
+		void PollBackend();
+
+		// Indexed by GLFW joystick id
+		struct Slot {
+			std::shared_ptr<Joystick> joystick;
+			uint32_t generation = 0;
+		};
+		std::array<Slot, SLOT_COUNT> m_slots;
 		std::vector<std::shared_ptr<Joystick>> m_joysticks;
 		std::function<void(const Joystick &, uint32_t, KeyState, KeyState)> m_joystickButtonCallback = nullptr;
 		std::function<void(const Joystick &, uint32_t, float, float)> m_joystickAxisCallback = nullptr;
 		std::function<void(const Joystick &, JoystickState)> m_joystickStateCallback = nullptr;
+		std::function<void(const Joystick &, uint32_t, KeyState, Modifier)> m_joystickAxisButtonCallback = nullptr;
+		std::optional<JoystickAxisConfig> m_axisConfig {};
+		std::function<void(const Joystick &, GamepadButton, KeyState, KeyState)> m_gamepadButtonCallback = nullptr;
+		std::shared_ptr<InputRecorder> m_inputRecorder;
+		std::unique_ptr<JoystickBackend> m_backend;
+
+		// Scratch buffers for PollGamepads
+		std::vector<Joystick *> m_gamepads;
+		std::vector<GLFWgamepadstate> m_rawGamepadStates;
+		std::vector<GamepadState> m_gamepadStates;
 	};
 };
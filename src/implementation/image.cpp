@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+#include <cstring>
+#include "interface/definitions.hpp"
+#ifdef IGLFW_SSE2
+#include <emmintrin.h>
+#endif
+
+module pragma.platform;
+
+import :image;
+
+using namespace pragma::platform;
+
+uint64_t pragma::platform::detail::hash_image_data(const unsigned char *data, size_t size, uint64_t seed)
+{
+	// FNV-1a over 64-bit words. The multiplication only propagates bits upwards, so the upper half is folded back into
+	// the lower half after every word, otherwise the upper bytes of a word would never affect the low bits of the hash.
+	constexpr uint64_t prime = 1099511628211ull;
+	auto hash = seed;
+	size_t i = 0;
+	for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 32;
+	}
+	for(; i < size; ++i)
+		hash = (hash ^ data[i]) * prime;
+	return hash;
+}
+
+void pragma::platform::detail::swizzle_bgra_to_rgba(const unsigned char *src, unsigned char *dst, size_t pixelCount)
+{
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	auto maskGA = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+	auto maskLow = _mm_set1_epi32(0xFF);
+	for(; i + 4 <= pixelCount; i += 4) {
+		auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+		// Swap bytes 0 and 2 of every pixel
+		auto ga = _mm_and_si128(v, maskGA);
+		auto r = _mm_and_si128(_mm_srli_epi32(v, 16), maskLow);
+		auto b = _mm_slli_epi32(_mm_and_si128(v, maskLow), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(ga, _mm_or_si128(r, b)));
+	}
+#endif
+	for(; i < pixelCount; ++i) {
+		auto *s = src + i * 4;
+		auto *d = dst + i * 4;
+		auto b = s[0];
+		auto g = s[1];
+		auto r = s[2];
+		auto a = s[3];
+		d[0] = r;
+		d[1] = g;
+		d[2] = b;
+		d[3] = a;
+	}
+}
+
+void pragma::platform::detail::unpremultiply_rgba8(unsigned char *pixels, size_t pixelCount)
+{
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	auto zero = _mm_setzero_si128();
+	auto alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	auto v255 = _mm_set1_ps(255.f);
+	auto vHalf = _mm_set1_ps(0.5f);
+	auto unpremultiply = [&](__m128i pixel) {
+		auto v = _mm_cvtepi32_ps(pixel);
+		auto a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+		auto factor = _mm_and_ps(_mm_div_ps(v255, a), _mm_cmpneq_ps(a, _mm_setzero_ps()));
+		auto rgb = _mm_min_ps(_mm_add_ps(_mm_mul_ps(v, factor), vHalf), v255);
+		// The alpha channel is kept as is
+		return _mm_cvttps_epi32(_mm_or_ps(_mm_andnot_ps(alphaMask, rgb), _mm_and_ps(alphaMask, v)));
+	};
+	for(; i + 4 <= pixelCount; i += 4) {
+		auto *p = reinterpret_cast<__m128i *>(pixels + i * 4);
+		auto v = _mm_loadu_si128(p);
+		auto lo = _mm_unpacklo_epi8(v, zero);
+		auto hi = _mm_unpackhi_epi8(v, zero);
+		auto p0 = unpremultiply(_mm_unpacklo_epi16(lo, zero));
+		auto p1 = unpremultiply(_mm_unpackhi_epi16(lo, zero));
+		auto p2 = unpremultiply(_mm_unpacklo_epi16(hi, zero));
+		auto p3 = unpremultiply(_mm_unpackhi_epi16(hi, zero));
+		_mm_storeu_si128(p, _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+	}
+#endif
+	for(; i < pixelCount; ++i) {
+		auto *p = pixels + i * 4;
+		auto a = static_cast<float>(p[3]);
+		auto factor = (p[3] != 0) ? 255.f / a : 0.f;
+		for(size_t c = 0; c < 3; ++c)
+			p[c] = static_cast<unsigned char>(std::min(static_cast<float>(p[c]) * factor + 0.5f, 255.f));
+	}
+}
+
+void pragma::platform::detail::convert_rgba32f_to_rgba8(const float *src, unsigned char *dst, size_t pixelCount)
+{
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	auto one = _mm_set1_ps(1.f);
+	auto v255 = _mm_set1_ps(255.f);
+	auto vHalf = _mm_set1_ps(0.5f);
+	auto convert = [&](const float *p) {
+		// NaN values are mapped to 0
+		auto v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), _mm_setzero_ps()), one);
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, v255), vHalf));
+	};
+	for(; i + 4 <= pixelCount; i += 4) {
+		auto *p = src + i * 4;
+		auto lo = _mm_packs_epi32(convert(p), convert(p + 4));
+		auto hi = _mm_packs_epi32(convert(p + 8), convert(p + 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for(i *= 4; i < pixelCount * 4; ++i) {
+		auto v = (src[i] > 0.f) ? src[i] : 0.f;
+		v = (v < 1.f) ? v : 1.f;
+		dst[i] = static_cast<unsigned char>(v * 255.f + 0.5f);
+	}
+}
+
+Image pragma::platform::convert_to_rgba8(const ImageView &image)
+{
+	Image result {};
+	if(!image.data || image.width == 0 || image.height == 0)
+		return result;
+	result.width = image.width;
+	result.height = image.height;
+	result.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+	auto bytesPerPixel = (image.format == PixelFormat::RGBA32F) ? sizeof(float) * 4 : 4;
+	auto packedPitch = image.width * bytesPerPixel;
+	auto pitch = (image.rowPitch != 0) ? image.rowPitch : packedPitch;
+	auto *src = static_cast<const unsigned char *>(image.data);
+	std::vector<float> floatRow;
+	if(image.format == PixelFormat::RGBA32F)
+		floatRow.resize(static_cast<size_t>(image.width) * 4);
+	for(uint32_t y = 0; y < image.height; ++y) {
+		auto *srcRow = src + y * pitch;
+		auto *dstRow = result.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+		switch(image.format) {
+		case PixelFormat::RGBA8:
+			std::memcpy(dstRow, srcRow, packedPitch);
+			break;
+		case PixelFormat::BGRA8:
+			detail::swizzle_bgra_to_rgba(srcRow, dstRow, image.width);
+			break;
+		case PixelFormat::RGBA32F:
+			{
+				// The rows may not be aligned to floats
+				std::memcpy(floatRow.data(), srcRow, packedPitch);
+				detail::convert_rgba32f_to_rgba8(floatRow.data(), dstRow, image.width);
+				break;
+			}
+		default:
+			break;
+		}
+		static_assert(math::to_integral(PixelFormat::Count) == 3, "Update this list when new pixel formats have been added!");
+	}
+	if(image.premultiplied)
+		detail::unpremultiply_rgba8(result.pixels.data(), result.pixels.size() / 4);
+	return result;
+}
+
+namespace {
+	// Source pixels and weights that contribute to each destination pixel of a row or column
+	struct FilterContributions {
+		std::vector<uint32_t> first;
+		std::vector<uint32_t> offsets;
+		std::vector<float> weights;
+	};
+	FilterContributions compute_box_contributions(uint32_t srcSize, uint32_t dstSize)
+	{
+		FilterContributions contributions {};
+		contributions.first.resize(dstSize);
+		contributions.offsets.resize(dstSize + 1);
+		auto scale = static_cast<double>(srcSize) / dstSize;
+		for(uint32_t i = 0; i < dstSize; ++i) {
+			auto start = i * scale;
+			auto end = (i + 1) * scale;
+			auto first = std::min(static_cast<uint32_t>(start), srcSize - 1);
+			auto last = std::min(static_cast<uint32_t>(std::ceil(end)), srcSize);
+			contributions.first[i] = first;
+			contributions.offsets[i] = static_cast<uint32_t>(contributions.weights.size());
+			for(auto j = first; j < std::max(last, first + 1); ++j) {
+				auto coverage = std::min<double>(end, j + 1) - std::max<double>(start, j);
+				contributions.weights.push_back(static_cast<float>(std::max(coverage, 0.0) / scale));
+			}
+		}
+		contributions.offsets[dstSize] = static_cast<uint32_t>(contributions.weights.size());
+		return contributions;
+	}
+};
+
+Image pragma::platform::downscale_image(const Image &image, uint32_t width, uint32_t height)
+{
+	if(image.width == 0 || image.height == 0 || width == 0 || height == 0)
+		return {};
+	if(image.width == width && image.height == height)
+		return image;
+	auto horizontal = compute_box_contributions(image.width, width);
+	auto vertical = compute_box_contributions(image.height, height);
+
+	// The color channels are weighted by alpha, so fully transparent pixels don't bleed into the result
+	std::vector<float> tmp(static_cast<size_t>(width) * image.height * 4);
+	for(uint32_t y = 0; y < image.height; ++y) {
+		auto *srcRow = image.pixels.data() + static_cast<size_t>(y) * image.width * 4;
+		auto *tmpRow = tmp.data() + static_cast<size_t>(y) * width * 4;
+		for(uint32_t x = 0; x < width; ++x) {
+			std::array<float, 4> sum {};
+			auto *src = srcRow + horizontal.first[x] * 4;
+			for(auto i = horizontal.offsets[x]; i < horizontal.offsets[x + 1]; ++i, src += 4) {
+				auto wa = horizontal.weights[i] * src[3];
+				sum[0] += src[0] * wa;
+				sum[1] += src[1] * wa;
+				sum[2] += src[2] * wa;
+				sum[3] += wa;
+			}
+			std::copy(sum.begin(), sum.end(), tmpRow + x * 4);
+		}
+	}
+
+	Image result {};
+	result.width = width;
+	result.height = height;
+	result.pixels.resize(static_cast<size_t>(width) * height * 4);
+	std::vector<float> row(static_cast<size_t>(width) * 4);
+	for(uint32_t y = 0; y < height; ++y) {
+		std::fill(row.begin(), row.end(), 0.f);
+		for(auto i = vertical.offsets[y]; i < vertical.offsets[y + 1]; ++i) {
+			auto weight = vertical.weights[i];
+			auto *tmpRow = tmp.data() + static_cast<size_t>(vertical.first[y] + (i - vertical.offsets[y])) * width * 4;
+			for(size_t j = 0; j < row.size(); ++j)
+				row[j] += tmpRow[j] * weight;
+		}
+		auto *dstRow = result.pixels.data() + static_cast<size_t>(y) * width * 4;
+		for(uint32_t x = 0; x < width; ++x) {
+			auto *p = row.data() + x * 4;
+			auto a = p[3];
+			auto factor = (a > 0.f) ? 1.f / a : 0.f;
+			for(size_t c = 0; c < 3; ++c)
+				dstRow[x * 4 + c] = static_cast<unsigned char>(std::min(p[c] * factor + 0.5f, 255.f));
+			dstRow[x * 4 + 3] = static_cast<unsigned char>(std::min(a + 0.5f, 255.f));
+		}
+	}
+	return result;
+}
+
+namespace {
+	std::vector<Image> build_icon_set(const Image &source, std::span<const uint32_t> sizes)
+	{
+		std::vector<Image> icons;
+		if(source.pixels.empty())
+			return icons;
+		auto maxDim = std::max(source.width, source.height);
+		icons.reserve(sizes.size());
+		for(auto size : sizes) {
+			if(size == 0 || size > maxDim)
+				continue;
+			// Non-square images are fit into the icon size
+			auto w = std::max(static_cast<uint32_t>(static_cast<uint64_t>(source.width) * size / maxDim), 1u);
+			auto h = std::max(static_cast<uint32_t>(static_cast<uint64_t>(source.height) * size / maxDim), 1u);
+			icons.push_back(downscale_image(source, w, h));
+		}
+		if(icons.empty())
+			icons.push_back(source);
+		return icons;
+	}
+};
+
+std::vector<Image> pragma::platform::create_icon_set(const ImageView &image, std::span<const uint32_t> sizes) { return build_icon_set(convert_to_rgba8(image), sizes); }
+
+namespace {
+	struct IconSetCacheEntry {
+		uint64_t hash = 0;
+		// Converted source image, which is compared against in addition to the hash
+		Image source;
+		std::shared_ptr<const std::vector<Image>> icons;
+	};
+	constexpr size_t ICON_SET_CACHE_SIZE = 8;
+	std::deque<IconSetCacheEntry> g_iconSetCache;
+};
+
+std::shared_ptr<const std::vector<Image>> pragma::platform::detail::get_icon_set(const ImageView &image)
+{
+	// Images are compared after the conversion, so that e.g. the same image in different formats shares an icon set
+	auto source = convert_to_rgba8(image);
+	if(source.pixels.empty())
+		return nullptr;
+	auto hash = hash_image_data(source.pixels.data(), source.pixels.size());
+
+	auto it = std::find_if(g_iconSetCache.begin(), g_iconSetCache.end(),
+	  [&source, hash](const IconSetCacheEntry &entry) { return entry.hash == hash && entry.source.width == source.width && entry.source.height == source.height && entry.source.pixels == source.pixels; });
+	if(it != g_iconSetCache.end())
+		return it->icons;
+
+	auto icons = std::make_shared<const std::vector<Image>>(build_icon_set(source, DEFAULT_ICON_SIZES));
+	if(g_iconSetCache.size() >= ICON_SET_CACHE_SIZE)
+		g_iconSetCache.pop_front();
+	g_iconSetCache.push_back({hash, std::move(source), icons});
+	return icons;
+}
+
+void pragma::platform::detail::clear_icon_set_cache() { g_iconSetCache.clear(); }
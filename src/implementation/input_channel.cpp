@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module pragma.platform;
+
+import :input_channel;
+
+using namespace pragma::platform;
+
+InputChannel::InputChannel(uint32_t capacity)
+{
+	auto size = std::bit_ceil(std::max<uint32_t>(capacity, 2));
+	m_events = std::make_unique<InputEvent[]>(size);
+	m_mask = size - 1;
+}
+
+bool InputChannel::Push(const InputEvent &ev)
+{
+	auto writeIdx = m_writeIndex.load(std::memory_order_relaxed);
+	if(writeIdx - m_cachedReadIndex > m_mask) {
+		m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+		if(writeIdx - m_cachedReadIndex > m_mask) {
+			m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+	m_events[writeIdx & m_mask] = ev;
+	m_writeIndex.store(writeIdx + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputChannel::Pop(InputEvent &outEvent)
+{
+	auto readIdx = m_readIndex.load(std::memory_order_relaxed);
+	if(readIdx == m_writeIndex.load(std::memory_order_acquire))
+		return false;
+	outEvent = m_events[readIdx & m_mask];
+	m_readIndex.store(readIdx + 1, std::memory_order_release);
+	return true;
+}
+
+size_t InputChannel::GetCapacity() const { return m_mask + 1; }
+size_t InputChannel::GetSize() const
+{
+	auto readIdx = m_readIndex.load(std::memory_order_acquire);
+	return m_writeIndex.load(std::memory_order_acquire) - readIdx;
+}
+uint64_t InputChannel::GetOverflowCount() const { return m_overflowCount.load(std::memory_order_relaxed); }
+uint64_t InputChannel::ResetOverflowCount() { return m_overflowCount.exchange(0, std::memory_order_relaxed); }
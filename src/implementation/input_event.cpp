@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cassert>
+
+module pragma.platform;
+
+import :input_event;
+
+using namespace pragma::platform;
+
+InputEventQueue::InputEventQueue(uint32_t initialCapacity) { m_events.resize(std::bit_ceil(std::max<uint32_t>(initialCapacity, 1))); }
+
+void InputEventQueue::Grow()
+{
+	// Re-linearize the ring so that the oldest event ends up at index 0
+	std::vector<InputEvent> events(m_events.size() * 2);
+	auto spans = GetEvents();
+	auto it = std::copy(spans[0].begin(), spans[0].end(), events.begin());
+	std::copy(spans[1].begin(), spans[1].end(), it);
+	m_events = std::move(events);
+	m_head = 0;
+}
+
+void InputEventQueue::Push(const InputEvent &ev)
+{
+	if(m_size == m_events.size())
+		Grow();
+	m_events[(m_head + m_size) & (m_events.size() - 1)] = ev;
+	++m_size;
+}
+
+void InputEventQueue::PushDrop(int count, const char **paths, double time)
+{
+	InputEvent ev {InputEvent::Type::Drop, time};
+	ev.drop = {static_cast<uint32_t>(m_dropPaths.size()), static_cast<uint32_t>(count)};
+	m_dropPaths.emplace_back().Assign(count, paths);
+	Push(ev);
+}
+
+bool InputEventQueue::Pop(InputEvent &outEvent)
+{
+	if(m_size == 0)
+		return false;
+	outEvent = m_events[m_head];
+	m_head = (m_head + 1) & (m_events.size() - 1);
+	if(--m_size == 0)
+		m_head = 0;
+	return true;
+}
+
+void InputEventQueue::Clear()
+{
+	m_head = 0;
+	m_size = 0;
+	m_dropPaths.clear();
+}
+
+void InputEventQueue::ReleaseDropPaths()
+{
+	// The paths of queued drop events are indexed by position, so they can only be released once all of them have been consumed
+	if(m_size == 0)
+		m_dropPaths.clear();
+}
+
+size_t InputEventQueue::GetSize() const { return m_size; }
+bool InputEventQueue::IsEmpty() const { return m_size == 0; }
+
+std::array<std::span<const InputEvent>, 2> InputEventQueue::GetEvents() const
+{
+	auto n = std::min(m_size, m_events.size() - m_head);
+	return {std::span<const InputEvent> {m_events.data() + m_head, n}, std::span<const InputEvent> {m_events.data(), m_size - n}};
+}
+
+std::span<const InputEvent> InputEventQueue::GetContiguousEvents()
+{
+	if(m_head + m_size > m_events.size()) {
+		std::rotate(m_events.begin(), m_events.begin() + m_head, m_events.end());
+		m_head = 0;
+	}
+	return {m_events.data() + m_head, m_size};
+}
+
+DropPathList &InputEventQueue::GetDropPathList(const InputEvent &ev)
+{
+	assert(ev.type == InputEvent::Type::Drop && ev.drop.pathIndex < m_dropPaths.size());
+	return m_dropPaths[ev.drop.pathIndex];
+}
+std::span<const std::string_view> InputEventQueue::GetDropPaths(const InputEvent &ev) const { return const_cast<InputEventQueue *>(this)->GetDropPathList(ev).GetPaths(); }
+
+int64_t pragma::platform::get_input_tick_index(double time, double firstTickTime, double tickInterval) { return static_cast<int64_t>(std::floor((time - firstTickTime) / tickInterval)); }
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <cstddef>
+
+module pragma.platform;
+
+import :input_recording;
+
+using namespace pragma::platform;
+
+std::expected<std::shared_ptr<InputRecorder>, std::string> InputRecorder::Create(const std::string &fileName)
+{
+	auto recorder = std::shared_ptr<InputRecorder>(new InputRecorder());
+	recorder->m_file.open(fileName, std::ios::binary | std::ios::out | std::ios::trunc);
+	if(!recorder->m_file.is_open())
+		return std::unexpected {std::format("Failed to open input log '{}' for writing!", fileName)};
+	input_log::FileHeader header {};
+	header.magic = input_log::MAGIC;
+	header.version = input_log::VERSION;
+	header.eventSize = sizeof(InputEvent);
+	header.startTime = get_time();
+	recorder->m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	return recorder;
+}
+
+InputRecorder::~InputRecorder() { Flush(); }
+
+void InputRecorder::WriteRecord(input_log::RecordType type, double time, const void *data, uint32_t size)
+{
+	input_log::RecordHeader header {type, size, time};
+	m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	m_file.write(static_cast<const char *>(data), size);
+	++m_recordCount;
+}
+
+void InputRecorder::RecordEvent(const InputEvent &ev)
+{
+	// Only the active member of the event data is copied into a zero-initialized record, so that no uninitialized
+	// bytes (padding or the unused part of the union) end up in the log
+	std::array<uint8_t, sizeof(InputEvent)> record {};
+	auto write = [&record](size_t offset, const auto &value) { memcpy(record.data() + offset, &value, sizeof(value)); };
+	write(offsetof(InputEvent, type), ev.type);
+	write(offsetof(InputEvent, time), ev.time);
+	// All members of the union share the same offset
+	constexpr auto dataOffset = offsetof(InputEvent, key);
+	switch(ev.type) {
+	case InputEvent::Type::Key:
+		write(dataOffset, ev.key);
+		break;
+	case InputEvent::Type::Char:
+	case InputEvent::Type::CharMods:
+		write(dataOffset, ev.character);
+		break;
+	case InputEvent::Type::MouseButton:
+		write(dataOffset, ev.mouseButton);
+		break;
+	case InputEvent::Type::Scroll:
+		write(dataOffset, ev.scroll);
+		break;
+	case InputEvent::Type::CursorPos:
+		write(dataOffset, ev.cursorPos);
+		break;
+	case InputEvent::Type::CursorEnter:
+		write(dataOffset, ev.cursorEnter);
+		break;
+	case InputEvent::Type::Focus:
+		write(dataOffset, ev.focus);
+		break;
+	case InputEvent::Type::Iconify:
+		write(dataOffset, ev.iconify);
+		break;
+	case InputEvent::Type::Resize:
+		write(dataOffset, ev.resize);
+		break;
+	case InputEvent::Type::WindowPos:
+		write(dataOffset, ev.windowPos);
+		break;
+	case InputEvent::Type::WindowSize:
+		write(dataOffset, ev.windowSize);
+		break;
+	case InputEvent::Type::Drop:
+		write(dataOffset, ev.drop);
+		break;
+	case InputEvent::Type::DragEnter:
+	case InputEvent::Type::DragExit:
+		break;
+	}
+	static_assert(math::to_integral(InputEvent::Type::Count) == 15, "Update this list when new event types are added!");
+	WriteRecord(input_log::RecordType::Event, ev.time, record.data(), static_cast<uint32_t>(record.size()));
+}
+
+void InputRecorder::RecordDrop(int count, const char **paths, double time)
+{
+	m_scratch.clear();
+	auto append = [this](const void *data, size_t size) { m_scratch.insert(m_scratch.end(), static_cast<const char *>(data), static_cast<const char *>(data) + size); };
+	auto pathCount = static_cast<uint32_t>(count);
+	append(&pathCount, sizeof(pathCount));
+	for(auto i = decltype(count) {0}; i < count; ++i) {
+		auto len = static_cast<uint32_t>(strlen(paths[i]));
+		append(&len, sizeof(len));
+		append(paths[i], len);
+	}
+	WriteRecord(input_log::RecordType::Drop, time, m_scratch.data(), static_cast<uint32_t>(m_scratch.size()));
+}
+
+void InputRecorder::RecordJoystickButton(int32_t joystickId, uint32_t button, KeyState oldState, KeyState newState, double time)
+{
+	input_log::JoystickButtonRecord record {joystickId, button, oldState, newState};
+	WriteRecord(input_log::RecordType::JoystickButton, time, &record, sizeof(record));
+}
+
+void InputRecorder::RecordJoystickAxis(int32_t joystickId, uint32_t axis, float oldValue, float newValue, double time)
+{
+	input_log::JoystickAxisRecord record {joystickId, axis, oldValue, newValue};
+	WriteRecord(input_log::RecordType::JoystickAxis, time, &record, sizeof(record));
+}
+
+void InputRecorder::Flush() { m_file.flush(); }
+uint64_t InputRecorder::GetRecordCount() const { return m_recordCount; }
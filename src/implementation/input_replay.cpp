@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <GLFW/glfw3.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+module pragma.platform;
+
+import :input_replay;
+import :joystick_handler;
+
+using namespace pragma::platform;
+
+std::expected<std::unique_ptr<InputReplay>, std::string> InputReplay::Open(const std::string &fileName)
+{
+	auto replay = std::unique_ptr<InputReplay>(new InputReplay());
+#ifdef _WIN32
+	auto hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(hFile == INVALID_HANDLE_VALUE)
+		return std::unexpected {std::format("Failed to open input log '{}'!", fileName)};
+	replay->m_fileHandle = hFile;
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(hFile, &size))
+		return std::unexpected {std::format("Failed to determine size of input log '{}'!", fileName)};
+	replay->m_size = static_cast<size_t>(size.QuadPart);
+	if(replay->m_size > 0) {
+		auto hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(!hMapping)
+			return std::unexpected {std::format("Failed to map input log '{}'!", fileName)};
+		replay->m_mappingHandle = hMapping;
+		replay->m_data = static_cast<const uint8_t *>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+	}
+#else
+	auto fd = open(fileName.c_str(), O_RDONLY);
+	if(fd == -1)
+		return std::unexpected {std::format("Failed to open input log '{}'!", fileName)};
+	struct stat st {};
+	if(fstat(fd, &st) != 0) {
+		close(fd);
+		return std::unexpected {std::format("Failed to determine size of input log '{}'!", fileName)};
+	}
+	replay->m_size = static_cast<size_t>(st.st_size);
+	if(replay->m_size > 0) {
+		auto *data = mmap(nullptr, replay->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data != MAP_FAILED) {
+			madvise(data, replay->m_size, MADV_SEQUENTIAL);
+			replay->m_data = static_cast<const uint8_t *>(data);
+		}
+	}
+	// The mapping stays valid after the descriptor has been closed
+	close(fd);
+#endif
+	if(!replay->m_data)
+		return std::unexpected {std::format("Failed to map input log '{}'!", fileName)};
+
+	input_log::FileHeader header;
+	if(replay->m_size < sizeof(header))
+		return std::unexpected {std::format("Input log '{}' is truncated!", fileName)};
+	memcpy(&header, replay->m_data, sizeof(header));
+	if(header.magic != input_log::MAGIC)
+		return std::unexpected {std::format("'{}' is not an input log!", fileName)};
+	if(header.version != input_log::VERSION || header.eventSize != sizeof(InputEvent))
+		return std::unexpected {std::format("Input log '{}' has an incompatible format (version {}, event size {})!", fileName, header.version, header.eventSize)};
+	replay->m_offset = sizeof(header);
+	replay->m_startTime = header.startTime;
+	replay->m_timeBase = get_time();
+	return replay;
+}
+
+InputReplay::~InputReplay()
+{
+#ifdef _WIN32
+	if(m_data)
+		UnmapViewOfFile(m_data);
+	if(m_mappingHandle)
+		CloseHandle(m_mappingHandle);
+	if(m_fileHandle)
+		CloseHandle(m_fileHandle);
+#else
+	if(m_data)
+		munmap(const_cast<uint8_t *>(m_data), m_size);
+#endif
+}
+
+void InputReplay::SetTargetWindow(Window *window) { m_targetWindow = window; }
+void InputReplay::SetTimeBase(double timeBase) { m_timeBase = timeBase; }
+bool InputReplay::IsComplete() const { return m_offset + sizeof(input_log::RecordHeader) > m_size; }
+uint64_t InputReplay::GetReplayedRecordCount() const { return m_replayedRecordCount; }
+
+bool InputReplay::Advance(double time)
+{
+	while(!IsComplete()) {
+		input_log::RecordHeader header;
+		memcpy(&header, m_data + m_offset, sizeof(header));
+		if(header.time - m_startTime > time)
+			return true;
+		auto *payload = m_data + m_offset + sizeof(header);
+		if(payload + header.size > m_data + m_size) {
+			// Truncated record, e.g. if the recording application crashed
+			m_offset = m_size;
+			break;
+		}
+		m_offset += sizeof(header) + header.size;
+		ReplayRecord(header, payload);
+	}
+	return false;
+}
+
+void InputReplay::ReplayAll() { Advance(std::numeric_limits<double>::max()); }
+
+Joystick *InputReplay::GetJoystick(int32_t joystickId)
+{
+	// The id comes from the log, which may be corrupt
+	if(joystickId < GLFW_JOYSTICK_1 || joystickId > GLFW_JOYSTICK_LAST)
+		return nullptr;
+	auto it = m_joysticks.find(joystickId);
+	if(it == m_joysticks.end()) {
+		// The joystick that was recorded doesn't have to be connected, so no information is queried from GLFW
+		it = m_joysticks.insert(std::make_pair(joystickId, Joystick::Create(joystickId, 0, "", ""))).first;
+	}
+	return it->second.get();
+}
+
+void InputReplay::ReplayRecord(const input_log::RecordHeader &header, const uint8_t *payload)
+{
+	++m_replayedRecordCount;
+	auto time = m_timeBase + (header.time - m_startTime);
+	switch(header.type) {
+	case input_log::RecordType::Event:
+		{
+			if(!m_targetWindow || header.size != sizeof(InputEvent))
+				break;
+			InputEvent ev;
+			memcpy(&ev, payload, sizeof(ev));
+			// Drop events carry their paths separately and are only replayed from drop records
+			if(ev.type >= InputEvent::Type::Count || ev.type == InputEvent::Type::Drop)
+				break;
+			ev.time = time;
+			m_targetWindow->InjectEvent(ev);
+			break;
+		}
+	case input_log::RecordType::Drop:
+		{
+			if(!m_targetWindow || header.size < sizeof(uint32_t))
+				break;
+			auto *end = payload + header.size;
+			uint32_t count;
+			memcpy(&count, payload, sizeof(count));
+			payload += sizeof(count);
+			m_dropPaths.clear();
+			for(uint32_t i = 0; i < count && payload + sizeof(uint32_t) <= end; ++i) {
+				uint32_t len;
+				memcpy(&len, payload, sizeof(len));
+				payload += sizeof(len);
+				if(payload + len > end)
+					break;
+				m_dropPaths.emplace_back(reinterpret_cast<const char *>(payload), len);
+				payload += len;
+			}
+			m_targetWindow->InjectDrop(m_dropPaths, time);
+			break;
+		}
+	case input_log::RecordType::JoystickButton:
+		{
+			auto *handler = JoystickHandler::FindInstance();
+			if(!handler || header.size != sizeof(input_log::JoystickButtonRecord))
+				break;
+			input_log::JoystickButtonRecord record;
+			memcpy(&record, payload, sizeof(record));
+			auto *joystick = GetJoystick(record.joystickId);
+			if(!joystick)
+				break;
+			handler->DispatchButtonEvent(*joystick, record.button, record.oldState, record.newState);
+			break;
+		}
+	case input_log::RecordType::JoystickAxis:
+		{
+			auto *handler = JoystickHandler::FindInstance();
+			if(!handler || header.size != sizeof(input_log::JoystickAxisRecord))
+				break;
+			input_log::JoystickAxisRecord record;
+			memcpy(&record, payload, sizeof(record));
+			auto *joystick = GetJoystick(record.joystickId);
+			if(!joystick)
+				break;
+			handler->DispatchAxisEvent(*joystick, record.axis, record.oldValue, record.newValue);
+			break;
+		}
+	default:
+		// Unknown record types are skipped, so that newer logs can still be replayed partially
+		break;
+	}
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module pragma.platform;
+
+import :input_state;
+
+using namespace pragma::platform;
+
+static uint64_t g_inputFrameIndex = 0;
+uint64_t pragma::platform::detail::get_input_frame_index() { return g_inputFrameIndex; }
+void pragma::platform::detail::advance_input_frame() { ++g_inputFrameIndex; }
+
+void InputState::RollOver()
+{
+	previous = current;
+	pressed = {};
+	released = {};
+}
+
+template<size_t TCount>
+static void set_button_state(InputState &state, ButtonBitSet<TCount> InputState::States::*member, size_t idx, KeyState keyState)
+{
+	if(idx >= TCount)
+		return;
+	switch(keyState) {
+	case KeyState::Press:
+		if(!(state.current.*member).Test(idx))
+			(state.pressed.*member).Set(idx);
+		(state.current.*member).Set(idx);
+		break;
+	case KeyState::Repeat:
+		(state.current.*member).Set(idx);
+		break;
+	case KeyState::Release:
+		if((state.current.*member).Test(idx))
+			(state.released.*member).Set(idx);
+		(state.current.*member).Reset(idx);
+		break;
+	default:
+		break;
+	}
+}
+
+void InputState::SetKeyState(Key key, KeyState state)
+{
+	// Key::Unknown is negative and can't be tracked
+	if(math::to_integral(key) < 0)
+		return;
+	set_button_state(*this, &States::keys, static_cast<size_t>(key), state);
+}
+void InputState::SetMouseButtonState(MouseButton button, KeyState state) { set_button_state(*this, &States::mouseButtons, static_cast<size_t>(button), state); }
+
+KeyState InputState::GetFrameState(bool down, bool wasDown)
+{
+	if(!down)
+		return KeyState::Release;
+	return wasDown ? KeyState::Held : KeyState::Press;
+}
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module pragma.platform;
+
+import :input_statistics;
+
+using namespace pragma::platform;
+
+uint32_t LatencyHistogram::GetBucketIndex(uint64_t ns)
+{
+	if(ns < SUB_BUCKET_COUNT)
+		return static_cast<uint32_t>(ns);
+	auto exp = static_cast<uint32_t>(std::bit_width(ns)) - 1;
+	auto sub = static_cast<uint32_t>((ns >> (exp - 2)) & (SUB_BUCKET_COUNT - 1));
+	return std::min((exp - 1) * SUB_BUCKET_COUNT + sub, BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyHistogram::GetBucketLowerBound(uint32_t bucketIndex)
+{
+	if(bucketIndex < SUB_BUCKET_COUNT)
+		return bucketIndex;
+	auto exp = bucketIndex / SUB_BUCKET_COUNT + 1;
+	auto sub = bucketIndex % SUB_BUCKET_COUNT;
+	return static_cast<uint64_t>(SUB_BUCKET_COUNT + sub) << (exp - 2);
+}
+
+void LatencyHistogram::Record(uint64_t ns)
+{
+	m_buckets[GetBucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+	m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+	auto curMax = m_maxNs.load(std::memory_order_relaxed);
+	while(ns > curMax && !m_maxNs.compare_exchange_weak(curMax, ns, std::memory_order_relaxed))
+		;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const
+{
+	Snapshot snapshot {};
+	for(auto i = decltype(m_buckets.size()) {0}; i < m_buckets.size(); ++i)
+		snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+	// The total count is derived from the buckets, so that it is consistent with them even if values are recorded concurrently
+	for(auto n : snapshot.buckets)
+		snapshot.count += n;
+	snapshot.totalNs = m_totalNs.load(std::memory_order_relaxed);
+	snapshot.maxNs = m_maxNs.load(std::memory_order_relaxed);
+	return snapshot;
+}
+
+void LatencyHistogram::Reset()
+{
+	for(auto &bucket : m_buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	m_totalNs.store(0, std::memory_order_relaxed);
+	m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::GetPercentile(double percentile) const
+{
+	if(count == 0)
+		return 0;
+	auto target = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 1.0) * static_cast<double>(count)));
+	target = std::max<uint64_t>(target, 1);
+	uint64_t cumulative = 0;
+	for(uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+		cumulative += buckets[i];
+		if(cumulative < target)
+			continue;
+		// Use the upper bound of the bucket, but never report more than the largest recorded value
+		auto upper = (i + 1 < BUCKET_COUNT) ? (GetBucketLowerBound(i + 1) - 1) : maxNs;
+		return std::min(upper, maxNs);
+	}
+	return maxNs;
+}
+
+double LatencyHistogram::Snapshot::GetMean() const
+{
+	if(count == 0)
+		return 0.0;
+	return static_cast<double>(totalNs) / static_cast<double>(count);
+}
+
+namespace {
+	struct InputStatisticsData {
+		LatencyHistogram pollEvents;
+		LatencyHistogram dispatchLatency;
+		std::array<LatencyHistogram, InputStatistics::EVENT_TYPE_COUNT> callbackDurations;
+		std::array<std::atomic<uint64_t>, InputStatistics::EVENT_TYPE_COUNT> eventCounts {};
+	};
+};
+static std::atomic<bool> g_inputStatisticsEnabled = false;
+static InputStatisticsData g_inputStatistics {};
+
+void pragma::platform::set_input_statistics_enabled(bool enabled) { g_inputStatisticsEnabled.store(enabled, std::memory_order_relaxed); }
+bool pragma::platform::is_input_statistics_enabled() { return g_inputStatisticsEnabled.load(std::memory_order_relaxed); }
+InputStatistics pragma::platform::get_input_statistics()
+{
+	InputStatistics stats {};
+	stats.pollEvents = g_inputStatistics.pollEvents.GetSnapshot();
+	stats.dispatchLatency = g_inputStatistics.dispatchLatency.GetSnapshot();
+	for(auto i = decltype(stats.callbackDurations.size()) {0}; i < stats.callbackDurations.size(); ++i) {
+		stats.callbackDurations[i] = g_inputStatistics.callbackDurations[i].GetSnapshot();
+		stats.eventCounts[i] = g_inputStatistics.eventCounts[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+void pragma::platform::reset_input_statistics()
+{
+	g_inputStatistics.pollEvents.Reset();
+	g_inputStatistics.dispatchLatency.Reset();
+	for(auto &histogram : g_inputStatistics.callbackDurations)
+		histogram.Reset();
+	for(auto &count : g_inputStatistics.eventCounts)
+		count.store(0, std::memory_order_relaxed);
+}
+
+void pragma::platform::detail::record_poll_duration(uint64_t ns) { g_inputStatistics.pollEvents.Record(ns); }
+void pragma::platform::detail::record_input_event(InputEvent::Type type) { g_inputStatistics.eventCounts[math::to_integral(type)].fetch_add(1, std::memory_order_relaxed); }
+void pragma::platform::detail::record_input_dispatch(const InputEvent &ev, uint64_t callbackDurationNs)
+{
+	g_inputStatistics.callbackDurations[math::to_integral(ev.type)].Record(callbackDurationNs);
+	auto latency = std::max(get_time() - ev.time, 0.0);
+	g_inputStatistics.dispatchLatency.Record(static_cast<uint64_t>(latency * 1'000'000'000.0));
+}
@@ -5,87 +5,270 @@ module;
 
 #include <cassert>
 #include <GLFW/glfw3.h>
+#include "interface/definitions.hpp"
+#ifdef IGLFW_SSE2
+#include <emmintrin.h>
+#endif
 
 module pragma.platform;
 
 using namespace pragma::platform;
 
-std::shared_ptr<Joystick> Joystick::Create(int32_t joystickId) { return std::shared_ptr<Joystick>(new Joystick(joystickId)); }
-Joystick::Joystick(int32_t joystickId) : m_joystickId(joystickId) {}
+std::shared_ptr<Joystick> Joystick::Create(int32_t joystickId, uint32_t generation)
+{
+	// May be nullptr, e.g. for replayed joysticks that aren't actually connected
+	auto *name = glfwGetJoystickName(joystickId);
+	auto *guid = glfwGetJoystickGUID(joystickId);
+	return Create(joystickId, generation, name ? name : "", guid ? guid : "");
+}
+std::shared_ptr<Joystick> Joystick::Create(int32_t joystickId, uint32_t generation, const std::string &name, const std::string &guid) { return std::shared_ptr<Joystick>(new Joystick(joystickId, generation, name, guid)); }
+Joystick::Joystick(int32_t joystickId, uint32_t generation, const std::string &name, const std::string &guid) : m_joystickId(joystickId), m_generation(generation), m_name(name), m_guid(guid) {}
+
+void pragma::platform::detail::apply_axis_deadzone(float *values, size_t count, float threshold)
+{
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	auto vThreshold = _mm_set1_ps(threshold);
+	for(; i + 4 <= count; i += 4) {
+		auto v = _mm_loadu_ps(values + i);
+		auto belowThreshold = _mm_cmplt_ps(_mm_and_ps(v, absMask), vThreshold);
+		_mm_storeu_ps(values + i, _mm_andnot_ps(belowThreshold, v));
+	}
+#endif
+	for(; i < count; ++i) {
+		if(math::abs(values[i]) < threshold)
+			values[i] = 0.f;
+	}
+}
+
+void pragma::platform::detail::compute_change_mask(const float *oldValues, const float *newValues, size_t count, uint64_t *outMask)
+{
+	std::fill_n(outMask, get_change_mask_word_count(count), uint64_t {0});
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	for(; i + 4 <= count; i += 4) {
+		auto bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(oldValues + i), _mm_loadu_ps(newValues + i))));
+		outMask[i / 64] |= bits << (i % 64);
+	}
+#endif
+	for(; i < count; ++i) {
+		if(oldValues[i] != newValues[i])
+			outMask[i / 64] |= uint64_t {1} << (i % 64);
+	}
+}
+
+void pragma::platform::detail::compute_change_mask(const uint8_t *oldValues, const uint8_t *newValues, size_t count, uint64_t *outMask)
+{
+	std::fill_n(outMask, get_change_mask_word_count(count), uint64_t {0});
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	for(; i + 16 <= count; i += 16) {
+		auto equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(oldValues + i)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(newValues + i)));
+		auto bits = static_cast<uint64_t>(~_mm_movemask_epi8(equal) & 0xFFFF);
+		outMask[i / 64] |= bits << (i % 64);
+	}
+#endif
+	for(; i < count; ++i) {
+		if(oldValues[i] != newValues[i])
+			outMask[i / 64] |= uint64_t {1} << (i % 64);
+	}
+}
 
 void Joystick::InitializeAxes(int32_t count)
 {
 	if(m_axes.size() == count)
 		return;
-	m_axes.resize(count);
-	std::fill(m_axes.begin(), m_axes.end(), 0.f);
-	m_oldAxes = m_axes;
+	m_axes.assign(count, 0.f);
+	m_oldAxes.assign(count, 0.f);
+	m_changedAxes.assign(detail::get_change_mask_word_count(count), 0);
+	if(!m_axisConfigs.empty()) {
+		// The configs are never shrunk, so per-axis configs survive a temporary disconnect
+		if(m_axisConfigs.size() < static_cast<size_t>(count))
+			m_axisConfigs.resize(count, m_defaultAxisConfig ? *m_defaultAxisConfig : JoystickAxisConfig {});
+		m_axisProcessingStates.assign(m_axisConfigs.size(), {});
+	}
 }
 
 void Joystick::InitializeButtonStates(int32_t count)
 {
 	if(m_buttonStates.size() == count)
 		return;
-	m_buttonStates.resize(count);
-	std::fill(m_buttonStates.begin(), m_buttonStates.end(), KeyState::Release);
-	m_oldButtonStates = m_buttonStates;
+	m_buttonStates.assign(count, KeyState::Release);
+	m_rawButtonStates.assign(count, GLFW_RELEASE);
+	m_oldRawButtonStates.assign(count, GLFW_RELEASE);
+	m_changedButtons.assign(detail::get_change_mask_word_count(count), 0);
 }
 
 int32_t Joystick::GetJoystickId() const { return m_joystickId; }
 
-std::string Joystick::GetName() const { return glfwGetJoystickName(m_joystickId); }
+uint32_t Joystick::GetGeneration() const { return m_generation; }
+const std::string &Joystick::GetName() const { return m_name; }
+const std::string &Joystick::GetGUID() const { return m_guid; }
 
 const std::vector<float> &Joystick::GetAxes() const { return m_axes; }
 const std::vector<KeyState> &Joystick::GetButtons() const { return m_buttonStates; }
 void Joystick::SetButtonCallback(const std::function<void(uint32_t, KeyState, KeyState)> &callback) { m_buttonCallback = callback; }
 void Joystick::SetAxisCallback(const std::function<void(uint32_t, float, float)> &callback) { m_axisCallback = callback; }
+void Joystick::SetAxisButtonCallback(const std::function<void(uint32_t, KeyState, Modifier)> &callback) { m_axisButtonCallback = callback; }
+
+void Joystick::SetAxisConfig(const JoystickAxisConfig &config)
+{
+	m_defaultAxisConfig = config;
+	m_axisConfigs.assign(std::max<size_t>(m_axes.size(), 1), config);
+	m_axisProcessingStates.assign(m_axisConfigs.size(), {});
+}
+void Joystick::SetAxisConfig(uint32_t axis, const JoystickAxisConfig &config)
+{
+	if(axis >= m_axisConfigs.size()) {
+		m_axisConfigs.resize(std::max<size_t>(axis + 1, m_axes.size()), m_defaultAxisConfig ? *m_defaultAxisConfig : JoystickAxisConfig {});
+		m_axisProcessingStates.resize(m_axisConfigs.size());
+	}
+	m_axisConfigs[axis] = config;
+}
+void Joystick::ClearAxisConfigs()
+{
+	m_defaultAxisConfig = {};
+	m_axisConfigs.clear();
+	m_axisProcessingStates.clear();
+}
+const JoystickAxisConfig *Joystick::GetAxisConfig(uint32_t axis) const { return (axis < m_axisConfigs.size()) ? &m_axisConfigs[axis] : nullptr; }
+
+double Joystick::GetPollTime() const { return m_pollTime; }
+
+bool Joystick::IsGamepad() const { return glfwJoystickIsGamepad(m_joystickId) == GLFW_TRUE; }
+const GamepadState &Joystick::GetGamepadState() const { return m_gamepadState; }
+void Joystick::SetGamepadState(const GamepadState &state) { m_gamepadState = state; }
 
 void Joystick::Poll()
 {
+	int axisCount = 0;
+	auto *axes = glfwGetJoystickAxes(GetJoystickId(), &axisCount);
+	int buttonCount = 0;
+	auto *buttons = glfwGetJoystickButtons(GetJoystickId(), &buttonCount);
+	Poll(axes, axisCount, buttons, buttonCount);
+}
+
+float Joystick::FilterAxis(const JoystickAxisConfig &config, AxisProcessingState &state, float value, float dt) const
+{
+	if(!state.initialized) {
+		state.initialized = true;
+		state.filtered = value;
+		state.derivative = 0.f;
+		return value;
+	}
+	auto filtered = value;
+	switch(config.filter) {
+	case JoystickAxisConfig::Filter::None:
+		break;
+	case JoystickAxisConfig::Filter::Exponential:
+		filtered = state.filtered + (value - state.filtered) * (1.f - std::clamp(config.smoothing, 0.f, 0.999f));
+		break;
+	case JoystickAxisConfig::Filter::OneEuro:
+		{
+			if(dt <= 0.f)
+				return state.filtered;
+			auto getAlpha = [dt](float cutoff) {
+				auto tau = 1.f / (2.f * std::numbers::pi_v<float> * std::max(cutoff, 0.0001f));
+				return 1.f / (1.f + tau / dt);
+			};
+			auto derivative = (value - state.filtered) / dt;
+			state.derivative += (derivative - state.derivative) * getAlpha(config.derivativeCutoff);
+			auto cutoff = config.minCutoff + config.beta * std::abs(state.derivative);
+			filtered = state.filtered + (value - state.filtered) * getAlpha(cutoff);
+			break;
+		}
+	}
+	// Smoothed values only approach the rest position asymptotically
+	if(value == 0.f && std::abs(filtered) < std::max(config.changeEpsilon, 0.001f))
+		filtered = 0.f;
+	state.filtered = filtered;
+	return filtered;
+}
+
+void Joystick::UpdateAxisButton(uint32_t axis, const JoystickAxisConfig &config, AxisProcessingState &state, float value)
+{
+	auto dispatch = [this, axis](KeyState keyState, int8_t direction) {
+		if(m_axisButtonCallback == nullptr)
+			return;
+		auto mods = Modifier::AxisInput | ((keyState == KeyState::Press) ? Modifier::AxisPress : Modifier::AxisRelease);
+		if(direction < 0)
+			mods = mods | Modifier::AxisNegative;
+		m_axisButtonCallback(axis, keyState, mods);
+	};
+	if(state.buttonDirection != 0) {
+		if(value * static_cast<float>(state.buttonDirection) >= config.releaseThreshold)
+			return;
+		auto direction = state.buttonDirection;
+		state.buttonDirection = 0;
+		dispatch(KeyState::Release, direction);
+	}
+	if(std::abs(value) >= config.pressThreshold) {
+		state.buttonDirection = (value < 0.f) ? -1 : 1;
+		dispatch(KeyState::Press, state.buttonDirection);
+	}
+}
+
+void Joystick::ProcessAxes()
+{
+	if(m_axisConfigs.size() < m_axes.size()) {
+		m_axisConfigs.resize(m_axes.size(), m_defaultAxisConfig ? *m_defaultAxisConfig : JoystickAxisConfig {});
+		m_axisProcessingStates.resize(m_axes.size());
+	}
+	auto dt = static_cast<float>(m_pollTime - m_prevPollTime);
+	for(uint32_t i = 0; i < m_axes.size(); ++i) {
+		auto &config = m_axisConfigs[i];
+		auto &state = m_axisProcessingStates[i];
+		auto value = FilterAxis(config, state, m_axes[i], dt);
+		m_axes[i] = value;
+		if(std::abs(value - state.reported) > config.changeEpsilon || (value == 0.f && state.reported != 0.f)) {
+			auto oldValue = state.reported;
+			state.reported = value;
+			if(m_axisCallback != nullptr)
+				m_axisCallback(i, oldValue, value);
+		}
+		if(config.generateButtonEvents)
+			UpdateAxisButton(i, config, state, value);
+	}
+}
+
+void Joystick::Poll(const float *values, int32_t count, const unsigned char *states, int32_t buttonCount)
+{
+	m_prevPollTime = m_pollTime;
+	m_pollTime = get_time();
+
 	// Update axes
-	m_oldAxes = m_axes;
-	int count = 0;
-	const float *values = glfwGetJoystickAxes(GetJoystickId(), &count);
+	std::swap(m_oldAxes, m_axes);
 	if(values != nullptr) {
 		InitializeAxes(count);
 		memcpy(m_axes.data(), values, sizeof(values[0]) * count);
-		auto threshold = get_joystick_axis_threshold();
-		for(auto &axis : m_axes) {
-			if(math::abs(axis) < threshold)
-				axis = 0.f;
-		}
+		detail::apply_axis_deadzone(m_axes.data(), m_axes.size(), get_joystick_axis_threshold());
 	}
 	else
 		std::fill(m_axes.begin(), m_axes.end(), 0.f);
 	assert(m_oldAxes.size() == m_axes.size());
-	if(m_axisCallback != nullptr) {
-		for(auto i = decltype(m_oldAxes.size()) {0}; i < m_oldAxes.size(); ++i) {
-			auto oldAxis = m_oldAxes.at(i);
-			auto newAxis = m_axes.at(i);
-			if(math::abs(newAxis) > 0.f || math::abs(oldAxis) > 0.f) // oldAxis > 0.f && newAxis == 0.f means the axis has been "unpressed"
-				m_axisCallback(i, oldAxis, newAxis);
-		}
+	if(!m_axisConfigs.empty())
+		ProcessAxes();
+	else if(m_axisCallback != nullptr) {
+		detail::compute_change_mask(m_oldAxes.data(), m_axes.data(), m_axes.size(), m_changedAxes.data());
+		detail::for_each_set_bit(m_changedAxes, [this](uint32_t axis) { m_axisCallback(axis, m_oldAxes[axis], m_axes[axis]); });
 	}
 
 	// Update buttons
-	m_oldButtonStates = m_buttonStates;
-	count = 0;
-	auto *states = glfwGetJoystickButtons(GetJoystickId(), &count);
+	std::swap(m_oldRawButtonStates, m_rawButtonStates);
 	if(states != nullptr) {
-		InitializeButtonStates(count);
-		for(auto i = decltype(count) {0}; i < count; ++i)
-			m_buttonStates.at(i) = static_cast<KeyState>(states[i]);
+		InitializeButtonStates(buttonCount);
+		memcpy(m_rawButtonStates.data(), states, sizeof(states[0]) * buttonCount);
 	}
 	else
-		std::fill(m_buttonStates.begin(), m_buttonStates.end(), KeyState::Release);
-	assert(m_oldButtonStates.size() == m_buttonStates.size());
-	if(m_buttonCallback != nullptr) {
-		for(auto i = decltype(m_oldButtonStates.size()) {0}; i < m_oldButtonStates.size(); ++i) {
-			auto oldState = m_oldButtonStates.at(i);
-			auto newState = m_buttonStates.at(i);
-			if(oldState == newState)
-				continue;
-			m_buttonCallback(i, oldState, newState);
-		}
-	}
+		std::fill(m_rawButtonStates.begin(), m_rawButtonStates.end(), static_cast<uint8_t>(GLFW_RELEASE));
+	assert(m_oldRawButtonStates.size() == m_rawButtonStates.size());
+	detail::compute_change_mask(m_oldRawButtonStates.data(), m_rawButtonStates.data(), m_rawButtonStates.size(), m_changedButtons.data());
+	detail::for_each_set_bit(m_changedButtons, [this](uint32_t button) {
+		auto oldState = m_buttonStates[button];
+		auto newState = static_cast<KeyState>(m_rawButtonStates[button]);
+		m_buttonStates[button] = newState;
+		if(m_buttonCallback != nullptr)
+			m_buttonCallback(button, oldState, newState);
+	});
 }
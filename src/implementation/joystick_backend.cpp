@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <GLFW/glfw3.h>
+
+module pragma.platform;
+
+import :joystick_backend;
+
+using namespace pragma::platform;
+
+const JoystickBackend::Device *JoystickBackend::FindDevice(int32_t joystickId) const
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT)
+		return nullptr;
+	auto &device = m_devices[joystickId];
+	return device.connected ? &device : nullptr;
+}
+std::span<const JoystickSample> JoystickBackend::GetSamples() const { return m_samples; }
+void JoystickBackend::ClearSamples() { m_samples.clear(); }
+
+void JoystickBackend::ConnectDevice(int32_t joystickId, const JoystickDeviceInfo &info)
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT)
+		return;
+	auto &device = m_devices[joystickId];
+	device.info = info;
+	device.axes.assign(info.axisCount, 0.f);
+	device.buttons.assign(info.buttonCount, GLFW_RELEASE);
+	device.connected = true;
+}
+
+void JoystickBackend::DisconnectDevice(int32_t joystickId)
+{
+	if(joystickId < 0 || static_cast<size_t>(joystickId) >= SLOT_COUNT)
+		return;
+	m_devices[joystickId].connected = false;
+}
+
+void JoystickBackend::ApplySample(const JoystickSample &sample)
+{
+	if(sample.joystickId < 0 || static_cast<size_t>(sample.joystickId) >= SLOT_COUNT)
+		return;
+	auto &device = m_devices[sample.joystickId];
+	if(!device.connected)
+		return;
+	switch(sample.type) {
+	case JoystickSample::Type::Axis:
+		if(sample.index >= device.axes.size())
+			return;
+		device.axes[sample.index] = sample.value;
+		break;
+	case JoystickSample::Type::Button:
+		if(sample.index >= device.buttons.size())
+			return;
+		device.buttons[sample.index] = (sample.value != 0.f) ? GLFW_PRESS : GLFW_RELEASE;
+		break;
+	}
+	m_samples.push_back(sample);
+}
+
+void MockJoystickBackend::Update()
+{
+	ClearSamples();
+	for(auto &change : m_pendingChanges) {
+		switch(change.type) {
+		case PendingChange::Type::Connect:
+			ConnectDevice(change.joystickId, change.info);
+			break;
+		case PendingChange::Type::Disconnect:
+			DisconnectDevice(change.joystickId);
+			break;
+		case PendingChange::Type::Sample:
+			ApplySample(change.sample);
+			break;
+		}
+	}
+	m_pendingChanges.clear();
+}
+
+void MockJoystickBackend::Connect(int32_t joystickId, const JoystickDeviceInfo &info) { m_pendingChanges.push_back({PendingChange::Type::Connect, joystickId, info, {}}); }
+void MockJoystickBackend::Disconnect(int32_t joystickId) { m_pendingChanges.push_back({PendingChange::Type::Disconnect, joystickId, {}, {}}); }
+void MockJoystickBackend::SetAxis(int32_t joystickId, uint32_t axis, float value, std::optional<double> time)
+{
+	JoystickSample sample {time ? *time : get_time(), joystickId, axis, value, JoystickSample::Type::Axis};
+	m_pendingChanges.push_back({PendingChange::Type::Sample, joystickId, {}, sample});
+}
+void MockJoystickBackend::SetButton(int32_t joystickId, uint32_t button, bool pressed, std::optional<double> time)
+{
+	JoystickSample sample {time ? *time : get_time(), joystickId, button, pressed ? static_cast<float>(GLFW_PRESS) : static_cast<float>(GLFW_RELEASE), JoystickSample::Type::Button};
+	m_pendingChanges.push_back({PendingChange::Type::Sample, joystickId, {}, sample});
+}
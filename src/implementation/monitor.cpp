@@ -4,6 +4,10 @@
 module;
 
 #include <GLFW/glfw3.h>
+#include "interface/definitions.hpp"
+#ifdef IGLFW_SSE2
+#include <emmintrin.h>
+#endif
 
 module pragma.platform;
 
@@ -11,21 +15,121 @@ import :monitor;
 
 using namespace pragma::platform;
 
-Monitor::Monitor(GLFWmonitor *monitor) : m_monitor(monitor) {}
+namespace {
+	struct MonitorCache {
+		std::vector<std::pair<GLFWmonitor *, std::shared_ptr<detail::MonitorInfo>>> infos;
+		std::optional<std::vector<Monitor>> monitors {};
+		MonitorTopologyChange pendingChange {};
+		bool changed = false;
+	};
+	MonitorCache g_monitorCache {};
 
-Monitor::~Monitor() {}
+	bool compare_video_modes(const GLFWvidmode &a, const GLFWvidmode &b)
+	{
+		if(a.width != b.width)
+			return a.width < b.width;
+		if(a.height != b.height)
+			return a.height < b.height;
+		if(a.refreshRate != b.refreshRate)
+			return a.refreshRate < b.refreshRate;
+		return (a.redBits + a.greenBits + a.blueBits) < (b.redBits + b.greenBits + b.blueBits);
+	}
 
-std::string Monitor::GetName() const { return glfwGetMonitorName(m_monitor); }
-const GLFWmonitor *Monitor::GetGLFWMonitor() const { return m_monitor; }
+	std::shared_ptr<detail::MonitorInfo> query_monitor_info(GLFWmonitor *monitor)
+	{
+		auto info = std::make_shared<detail::MonitorInfo>();
+		if(!monitor)
+			return info;
+		if(auto *name = glfwGetMonitorName(monitor))
+			info->name = name;
+		glfwGetMonitorPhysicalSize(monitor, &info->physicalSize.x, &info->physicalSize.y);
+		int count = 0;
+		auto *videoModes = glfwGetVideoModes(monitor, &count);
+		if(videoModes)
+			info->videoModes.assign(videoModes, videoModes + count);
+		info->videoModesByResolution.resize(info->videoModes.size());
+		std::iota(info->videoModesByResolution.begin(), info->videoModesByResolution.end(), 0u);
+		std::sort(info->videoModesByResolution.begin(), info->videoModesByResolution.end(), [&modes = info->videoModes](uint32_t a, uint32_t b) { return compare_video_modes(modes[a], modes[b]); });
+		return info;
+	}
+
+	std::shared_ptr<detail::MonitorInfo> get_monitor_info(GLFWmonitor *monitor)
+	{
+		auto &infos = g_monitorCache.infos;
+		auto it = std::find_if(infos.begin(), infos.end(), [monitor](const auto &pair) { return pair.first == monitor; });
+		if(it != infos.end())
+			return it->second;
+		auto info = query_monitor_info(monitor);
+		if(monitor)
+			infos.push_back({monitor, info});
+		return info;
+	}
+};
+
+Monitor pragma::platform::detail::on_monitor_event(GLFWmonitor *monitor, bool connected)
+{
+	auto &cache = g_monitorCache;
+	cache.monitors = {};
+	cache.changed = true;
+	auto &change = cache.pendingChange;
+	// The handle is still valid during the callback, so the cached properties can still be retrieved for the disconnect event.
+	// This has to happen before the cache entry is removed, otherwise a stale entry would be re-inserted for a handle that GLFW is about to free.
+	Monitor result {monitor};
+	if(connected) {
+		change.connected.push_back(result);
+		return result;
+	}
+	auto it = std::find_if(change.connected.begin(), change.connected.end(), [monitor](const Monitor &other) { return other.GetGLFWMonitor() == monitor; });
+	if(it != change.connected.end())
+		change.connected.erase(it);
+	else
+		change.disconnected.push_back(result);
+	auto &infos = cache.infos;
+	std::erase_if(infos, [monitor](const auto &pair) { return pair.first == monitor; });
+	return result;
+}
+
+bool pragma::platform::detail::pop_monitor_topology_change(MonitorTopologyChange &outChange)
+{
+	auto &cache = g_monitorCache;
+	if(!cache.changed)
+		return false;
+	cache.changed = false;
+	outChange = std::move(cache.pendingChange);
+	cache.pendingChange = {};
+	return !outChange.connected.empty() || !outChange.disconnected.empty();
+}
 
-Vector2i Monitor::GetPhysicalSize() const
+const std::vector<Monitor> &pragma::platform::detail::get_cached_monitors()
 {
-	int w = 0;
-	int h = 0;
-	glfwGetMonitorPhysicalSize(m_monitor, &w, &h);
-	return Vector2i(w, h);
+	auto &cache = g_monitorCache;
+	if(!is_initialized()) {
+		// Nothing is cached, so that the monitors are queried once GLFW has been initialized
+		static const std::vector<Monitor> noMonitors {};
+		return noMonitors;
+	}
+	if(!cache.monitors) {
+		auto &monitors = cache.monitors.emplace();
+		int count = 0;
+		auto *glfwMonitors = glfwGetMonitors(&count);
+		monitors.reserve(count);
+		for(auto i = decltype(count) {0}; i < count; ++i)
+			monitors.push_back(Monitor(glfwMonitors[i]));
+	}
+	return *cache.monitors;
 }
 
+void pragma::platform::detail::clear_monitor_cache() { g_monitorCache = {}; }
+
+Monitor::Monitor(GLFWmonitor *monitor) : m_monitor(monitor), m_info(get_monitor_info(monitor)) {}
+
+Monitor::~Monitor() {}
+
+const std::string &Monitor::GetName() const { return m_info->name; }
+const GLFWmonitor *Monitor::GetGLFWMonitor() const { return m_monitor; }
+
+Vector2i Monitor::GetPhysicalSize() const { return m_info->physicalSize; }
+
 Vector2i Monitor::GetPos() const
 {
 	int x = 0;
@@ -34,49 +138,169 @@ Vector2i Monitor::GetPos() const
 	return Vector2i(x, y);
 }
 
-std::vector<Vector3i> Monitor::GetGammaRamp() const
+void pragma::platform::generate_gamma_ramp(std::span<uint16_t> outRamp, float gamma, float brightness, float contrast)
+{
+	auto size = outRamp.size();
+	if(size == 0)
+		return;
+	if(!(gamma > 0.f) || !std::isfinite(gamma))
+		gamma = 1.f;
+	auto exponent = 1.f / gamma;
+	auto scale = (size > 1) ? 1.f / static_cast<float>(size - 1) : 0.f;
+	// Combine contrast, brightness and the conversion to [0,65535] into a single multiply-add
+	auto mul = contrast * 65535.f;
+	auto add = ((0.5f - 0.5f * contrast) + brightness) * 65535.f + 0.5f;
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	auto vMul = _mm_set1_ps(mul);
+	auto vAdd = _mm_set1_ps(add);
+	auto vMax = _mm_set1_ps(65535.f);
+	auto vBias = _mm_set1_epi32(0x8000);
+	for(; i + 8 <= size; i += 8) {
+		// There is no vectorized pow, the curve itself is evaluated in scalar code
+		alignas(16) std::array<float, 8> values;
+		for(size_t j = 0; j < values.size(); ++j)
+			values[j] = (exponent == 1.f) ? static_cast<float>(i + j) * scale : std::pow(static_cast<float>(i + j) * scale, exponent);
+		auto v0 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(values.data()), vMul), vAdd);
+		auto v1 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(values.data() + 4), vMul), vAdd);
+		v0 = _mm_min_ps(_mm_max_ps(v0, _mm_setzero_ps()), vMax);
+		v1 = _mm_min_ps(_mm_max_ps(v1, _mm_setzero_ps()), vMax);
+		// SSE2 only has a signed saturating pack, so the values are shifted into the signed range and back
+		auto i0 = _mm_sub_epi32(_mm_cvttps_epi32(v0), vBias);
+		auto i1 = _mm_sub_epi32(_mm_cvttps_epi32(v1), vBias);
+		auto packed = _mm_xor_si128(_mm_packs_epi32(i0, i1), _mm_set1_epi16(static_cast<short>(0x8000)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(outRamp.data() + i), packed);
+	}
+#endif
+	for(; i < size; ++i) {
+		auto v = (exponent == 1.f) ? static_cast<float>(i) * scale : std::pow(static_cast<float>(i) * scale, exponent);
+		outRamp[i] = static_cast<uint16_t>(std::clamp(v * mul + add, 0.f, 65535.f));
+	}
+}
+
+uint32_t Monitor::GetGammaRampSize() const
 {
+	if(m_info->gammaRampSize)
+		return *m_info->gammaRampSize;
+	if(!m_monitor)
+		return 0;
 	auto *gamma = glfwGetGammaRamp(m_monitor);
-	std::vector<Vector3i> r(gamma->size);
-	for(auto i = decltype(gamma->size) {0}; i < gamma->size; ++i) {
-		r[i][0] = gamma->red[i];
-		r[i][1] = gamma->green[i];
-		r[i][2] = gamma->blue[i];
+	if(!gamma)
+		return 0;
+	m_info->gammaRampSize = gamma->size;
+	m_info->gammaRamp.resize(gamma->size * 3);
+	auto *data = m_info->gammaRamp.data();
+	std::copy_n(gamma->red, gamma->size, data);
+	std::copy_n(gamma->green, gamma->size, data + gamma->size);
+	std::copy_n(gamma->blue, gamma->size, data + gamma->size * 2);
+	return gamma->size;
+}
+
+bool Monitor::GetGammaRamp(std::span<uint16_t> red, std::span<uint16_t> green, std::span<uint16_t> blue) const
+{
+	auto size = GetGammaRampSize();
+	if(size == 0 || red.size() != size || green.size() != size || blue.size() != size)
+		return false;
+	auto *data = m_info->gammaRamp.data();
+	std::copy_n(data, size, red.data());
+	std::copy_n(data + size, size, green.data());
+	std::copy_n(data + size * 2, size, blue.data());
+	return true;
+}
+
+bool Monitor::SetGammaRamp(std::span<const uint16_t> red, std::span<const uint16_t> green, std::span<const uint16_t> blue) const
+{
+	// Some platforms (e.g. X11) reject ramps that don't match the size of the hardware ramp
+	auto size = red.size();
+	if(size == 0 || size != GetGammaRampSize() || green.size() != size || blue.size() != size)
+		return false;
+	auto &cache = m_info->gammaRamp;
+	if(cache.size() == size * 3 && std::equal(red.begin(), red.end(), cache.begin()) && std::equal(green.begin(), green.end(), cache.begin() + size) && std::equal(blue.begin(), blue.end(), cache.begin() + size * 2))
+		return true;
+	// GLFW does not modify the ramp
+	GLFWgammaramp gamma {};
+	gamma.size = static_cast<unsigned int>(size);
+	gamma.red = const_cast<unsigned short *>(red.data());
+	gamma.green = const_cast<unsigned short *>(green.data());
+	gamma.blue = const_cast<unsigned short *>(blue.data());
+	// Clear any previous error, so that we can tell whether the ramp was accepted
+	glfwGetError(nullptr);
+	glfwSetGammaRamp(m_monitor, &gamma);
+	if(glfwGetError(nullptr) != GLFW_NO_ERROR)
+		return false;
+
+	cache.resize(size * 3);
+	std::copy(red.begin(), red.end(), cache.begin());
+	std::copy(green.begin(), green.end(), cache.begin() + size);
+	std::copy(blue.begin(), blue.end(), cache.begin() + size * 2);
+	return true;
+}
+
+std::vector<Vector3i> Monitor::GetGammaRamp() const
+{
+	auto size = GetGammaRampSize();
+	std::vector<Vector3i> r(size);
+	auto *data = m_info->gammaRamp.data();
+	for(auto i = decltype(size) {0}; i < size; ++i) {
+		r[i][0] = data[i];
+		r[i][1] = data[i + size];
+		r[i][2] = data[i + size * 2];
 	}
 	return r;
 }
 
-void Monitor::SetGammaRamp(const std::vector<Vector3i> gammaRamp) const
+void Monitor::SetGammaRamp(const std::vector<Vector3i> &gammaRamp) const
 {
-	GLFWgammaramp gamma {};
-	gamma.size = static_cast<uint32_t>(gammaRamp.size());
-	std::array<std::vector<std::remove_reference<decltype(*gamma.red)>::type>, 3> values;
-	for(auto it = values.begin(); it != values.end(); ++it)
-		it->reserve(gamma.size);
-	for(auto it = gammaRamp.begin(); it != gammaRamp.end(); ++it) {
-		values[0].push_back((*it)[0]);
-		values[1].push_back((*it)[1]);
-		values[2].push_back((*it)[2]);
+	auto size = gammaRamp.size();
+	std::vector<uint16_t> values(size * 3);
+	for(size_t i = 0; i < size; ++i) {
+		values[i] = static_cast<uint16_t>(gammaRamp[i][0]);
+		values[i + size] = static_cast<uint16_t>(gammaRamp[i][1]);
+		values[i + size * 2] = static_cast<uint16_t>(gammaRamp[i][2]);
 	}
-	gamma.red = values[0].data();
-	gamma.green = values[1].data();
-	gamma.blue = values[2].data();
-	glfwSetGammaRamp(m_monitor, &gamma);
+	std::span<const uint16_t> span {values};
+	SetGammaRamp(span.subspan(0, size), span.subspan(size, size), span.subspan(size * 2, size));
 }
 
-void Monitor::SetGamma(float gamma) const { glfwSetGamma(m_monitor, gamma); }
+void Monitor::SetGamma(float gamma, float brightness, float contrast) const
+{
+	auto size = GetGammaRampSize();
+	if(size == 0)
+		return;
+	// Generated into a separate buffer, so the cached ramp can still be compared against
+	std::vector<uint16_t> ramp(size);
+	generate_gamma_ramp(ramp, gamma, brightness, contrast);
+	SetGammaRamp(ramp, ramp, ramp);
+}
 
 Monitor::VideoMode Monitor::GetVideoMode() const { return *glfwGetVideoMode(m_monitor); }
 
-std::vector<Monitor::VideoMode> Monitor::GetSupportedVideoModes() const
+const std::vector<Monitor::VideoMode> &Monitor::GetSupportedVideoModes() const { return m_info->videoModes; }
+
+std::optional<Monitor::VideoMode> Monitor::FindVideoMode(const Vector2i &resolution, std::optional<int32_t> refreshRate, std::optional<int32_t> bitDepth) const
 {
-	std::vector<VideoMode> modes;
-	int count = 0;
-	auto *videoModes = glfwGetVideoModes(m_monitor, &count);
-	modes.reserve(count);
-	for(auto i = decltype(count) {0}; i < count; ++i) {
-		auto &mode = videoModes[i];
-		modes.push_back(mode);
+	auto &modes = m_info->videoModes;
+	auto &index = m_info->videoModesByResolution;
+	if(index.empty())
+		return {};
+	auto targetRefreshRate = static_cast<int64_t>(refreshRate.value_or(std::numeric_limits<int32_t>::max()));
+	auto targetBitDepth = static_cast<int64_t>(bitDepth.value_or(std::numeric_limits<int32_t>::max()));
+	auto getDiff = [&resolution, targetRefreshRate, targetBitDepth](const VideoMode &mode) {
+		auto dw = static_cast<int64_t>(mode.width) - resolution.x;
+		auto dh = static_cast<int64_t>(mode.height) - resolution.y;
+		return std::array<int64_t, 3> {dw * dw + dh * dh, std::abs(mode.refreshRate - targetRefreshRate), std::abs(mode.redBits + mode.greenBits + mode.blueBits - targetBitDepth)};
+	};
+
+	// Usually there is a mode with the exact resolution, in which case only the modes with that resolution have to be considered
+	auto itBegin = std::lower_bound(index.begin(), index.end(), resolution, [&modes](uint32_t idx, const Vector2i &res) { return (modes[idx].width != res.x) ? (modes[idx].width < res.x) : (modes[idx].height < res.y); });
+	auto itEnd = itBegin;
+	while(itEnd != index.end() && modes[*itEnd].width == resolution.x && modes[*itEnd].height == resolution.y)
+		++itEnd;
+	if(itBegin == itEnd) {
+		itBegin = index.begin();
+		itEnd = index.end();
 	}
-	return modes;
+
+	auto itBest = std::min_element(itBegin, itEnd, [&modes, &getDiff](uint32_t a, uint32_t b) { return getDiff(modes[a]) < getDiff(modes[b]); });
+	return modes[*itBest];
 }
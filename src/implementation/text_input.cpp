@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "interface/definitions.hpp"
+#ifdef IGLFW_SSE2
+#include <emmintrin.h>
+#endif
+
+module pragma.platform;
+
+import :text_input;
+
+using namespace pragma::platform;
+
+namespace {
+	bool is_valid_codepoint(uint32_t cp) { return cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF); }
+	size_t get_utf8_length(uint32_t cp)
+	{
+		if(cp < 0x80)
+			return 1;
+		if(cp < 0x800)
+			return 2;
+		if(cp < 0x10000 || !is_valid_codepoint(cp))
+			return 3;
+		return 4;
+	}
+	char *encode_utf8(uint32_t cp, char *out)
+	{
+		if(!is_valid_codepoint(cp))
+			cp = detail::UTF8_REPLACEMENT_CHARACTER;
+		if(cp < 0x80) {
+			*out++ = static_cast<char>(cp);
+			return out;
+		}
+		if(cp < 0x800) {
+			*out++ = static_cast<char>(0xC0 | (cp >> 6));
+			*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+			return out;
+		}
+		if(cp < 0x10000) {
+			*out++ = static_cast<char>(0xE0 | (cp >> 12));
+			*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+			return out;
+		}
+		*out++ = static_cast<char>(0xF0 | (cp >> 18));
+		*out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+		*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+		return out;
+	}
+};
+
+void pragma::platform::detail::encode_utf8(std::span<const uint32_t> codepoints, std::string &outText)
+{
+	auto offset = outText.size();
+	// Worst case, the string is shrunk to the actual size afterwards
+	outText.resize(offset + codepoints.size() * 4);
+	auto *out = outText.data() + offset;
+	size_t i = 0;
+#ifdef IGLFW_SSE2
+	// Text input is mostly ASCII, which can be narrowed eight codepoints at a time
+	auto nonAsciiMask = _mm_set1_epi32(~0x7F);
+	auto zero = _mm_setzero_si128();
+	for(; i + 8 <= codepoints.size();) {
+		auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codepoints.data() + i));
+		auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codepoints.data() + i + 4));
+		auto nonAscii = _mm_and_si128(_mm_or_si128(v0, v1), nonAsciiMask);
+		if(_mm_movemask_epi8(_mm_cmpeq_epi32(nonAscii, zero)) != 0xFFFF) {
+			// Encode the next codepoints individually until we're back to ASCII
+			auto end = i + 8;
+			for(; i < end; ++i)
+				out = ::encode_utf8(codepoints[i], out);
+			continue;
+		}
+		auto packed = _mm_packus_epi16(_mm_packs_epi32(v0, v1), zero);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(out), packed);
+		out += 8;
+		i += 8;
+	}
+#endif
+	for(; i < codepoints.size(); ++i)
+		out = ::encode_utf8(codepoints[i], out);
+	outText.resize(out - outText.data());
+}
+
+size_t pragma::platform::detail::get_utf8_length(std::span<const uint32_t> codepoints)
+{
+	size_t length = 0;
+	for(auto cp : codepoints)
+		length += ::get_utf8_length(cp);
+	return length;
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include <GLFW/glfw3.h>
+
+module pragma.platform;
+
+import :timer;
+
+using namespace pragma::platform;
+
+namespace {
+	struct TimerInfo {
+		// Kept alive by the caller while the callback is running, in case the timer is cancelled by its own callback
+		std::shared_ptr<std::function<void()>> callback;
+		TimerClock::time_point deadline;
+		// Zero for one-shot timers
+		TimerClock::duration interval {};
+	};
+	struct TimerHeapEntry {
+		TimerClock::time_point deadline;
+		TimerId id;
+		// Inverted for std::push_heap/std::pop_heap, so the earliest deadline is at the front
+		bool operator<(const TimerHeapEntry &other) const { return deadline > other.deadline; }
+	};
+	// Cancelled and rescheduled timers are not removed from the heap immediately; Stale entries are
+	// recognized by their deadline not matching the timer's current deadline (or the timer not existing anymore)
+	std::vector<TimerHeapEntry> g_timerHeap;
+	std::unordered_map<TimerId, TimerInfo> g_timers;
+	TimerId g_nextTimerId = 1;
+
+	void push_timer(TimerId id, TimerClock::time_point deadline)
+	{
+		g_timerHeap.push_back({deadline, id});
+		std::push_heap(g_timerHeap.begin(), g_timerHeap.end());
+	}
+	bool is_stale(const TimerHeapEntry &entry)
+	{
+		auto it = g_timers.find(entry.id);
+		return it == g_timers.end() || it->second.deadline != entry.deadline;
+	}
+	void pop_stale_timers()
+	{
+		while(!g_timerHeap.empty() && is_stale(g_timerHeap.front())) {
+			std::pop_heap(g_timerHeap.begin(), g_timerHeap.end());
+			g_timerHeap.pop_back();
+		}
+	}
+	TimerId add_timer(TimerClock::duration delay, TimerClock::duration interval, const std::function<void()> &callback)
+	{
+		if(!callback)
+			return INVALID_TIMER_ID;
+		auto id = g_nextTimerId++;
+		auto deadline = TimerClock::now() + std::max(delay, TimerClock::duration::zero());
+		g_timers[id] = {std::make_shared<std::function<void()>>(callback), deadline, interval};
+		push_timer(id, deadline);
+		return id;
+	}
+};
+
+TimerId pragma::platform::add_timer(TimerClock::duration delay, const std::function<void()> &callback) { return ::add_timer(delay, TimerClock::duration::zero(), callback); }
+TimerId pragma::platform::add_repeating_timer(TimerClock::duration interval, const std::function<void()> &callback)
+{
+	// A repeating timer with no interval would be fired on every poll, which is what poll_events() is for
+	interval = std::max(interval, TimerClock::duration {1});
+	return ::add_timer(interval, interval, callback);
+}
+bool pragma::platform::cancel_timer(TimerId id) { return g_timers.erase(id) > 0; }
+bool pragma::platform::is_timer_active(TimerId id) { return g_timers.find(id) != g_timers.end(); }
+std::optional<TimerClock::time_point> pragma::platform::get_next_timer_deadline()
+{
+	pop_stale_timers();
+	if(g_timerHeap.empty())
+		return {};
+	return g_timerHeap.front().deadline;
+}
+
+void pragma::platform::detail::process_timers()
+{
+	pop_stale_timers();
+	if(g_timerHeap.empty())
+		return;
+	auto now = TimerClock::now();
+	if(g_timerHeap.front().deadline > now)
+		return;
+	// Collect all due timers first, so that timers which are added or rescheduled by a callback can't be fired again during this call
+	static std::vector<TimerId> dueTimers;
+	auto numOuter = dueTimers.size();
+	while(!g_timerHeap.empty() && g_timerHeap.front().deadline <= now) {
+		auto entry = g_timerHeap.front();
+		std::pop_heap(g_timerHeap.begin(), g_timerHeap.end());
+		g_timerHeap.pop_back();
+		auto it = g_timers.find(entry.id);
+		if(it == g_timers.end() || it->second.deadline != entry.deadline)
+			continue;
+		dueTimers.push_back(entry.id);
+		auto &info = it->second;
+		if(info.interval == TimerClock::duration::zero())
+			continue;
+		info.deadline += info.interval;
+		if(info.deadline <= now)
+			info.deadline = now + info.interval;
+		push_timer(entry.id, info.deadline);
+	}
+	// Callbacks may poll events themselves, in which case this function is re-entered
+	for(auto i = numOuter; i < dueTimers.size(); ++i) {
+		// The timer may have been cancelled by one of the previous callbacks
+		auto it = g_timers.find(dueTimers[i]);
+		if(it == g_timers.end())
+			continue;
+		auto callback = it->second.callback;
+		if(it->second.interval == TimerClock::duration::zero())
+			g_timers.erase(it);
+		(*callback)();
+	}
+	dueTimers.resize(numOuter);
+}
+
+void pragma::platform::detail::clear_timers()
+{
+	g_timerHeap.clear();
+	g_timers.clear();
+}
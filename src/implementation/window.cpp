@@ -24,6 +24,31 @@ module;
 module pragma.platform;
 
 import :file_drop_target;
+import :input_statistics;
+import :input_state;
+import :image;
+import :drop;
+import :timer;
+import :text_input;
+
+// The clipboard is shared by all windows, so there is only one cache
+namespace {
+	struct ClipboardCache {
+		std::shared_ptr<const std::string> contents;
+		bool valid = false;
+	};
+};
+static ClipboardCache g_clipboardCache {};
+static const std::shared_ptr<const std::string> &get_clipboard_contents(GLFWwindow *window)
+{
+	if(!g_clipboardCache.valid || !g_clipboardCache.contents) {
+		auto *str = glfwGetClipboardString(window);
+		g_clipboardCache.contents = std::make_shared<const std::string>(str ? str : "");
+		g_clipboardCache.valid = true;
+	}
+	return g_clipboardCache.contents;
+}
+void pragma::platform::detail::clear_clipboard_cache() { g_clipboardCache = {}; }
 
 pragma::platform::WindowCreationInfo::WindowCreationInfo()
     : resizable(true), visible(true), decorated(true), focused(true), autoIconify(true), floating(false), stereo(false), srgbCapable(false), doublebuffer(true), refreshRate(GLFW_DONT_CARE), samples(0), redBits(8), greenBits(8), blueBits(8), alphaBits(8), depthBits(24), stencilBits(8),
@@ -45,101 +70,436 @@ pragma::platform::WindowHandle pragma::platform::Window::GetHandle() { return m_
 
 void pragma::platform::Window::Remove() { delete this; }
 
+void pragma::platform::Window::HandleEvent(InputEvent ev)
+{
+	ev.time = get_time();
+	CaptureEvent(ev);
+}
+
+void pragma::platform::Window::InjectEvent(const InputEvent &ev)
+{
+	// Drop events reference paths that are stored separately, see InjectDrop
+	if(ev.type >= InputEvent::Type::Count || ev.type == InputEvent::Type::Drop)
+		return;
+	CaptureEvent(ev);
+}
+
+void pragma::platform::Window::CaptureEvent(InputEvent ev)
+{
+	if(m_inputRecorder)
+		m_inputRecorder->RecordEvent(ev);
+	switch(ev.type) {
+	case InputEvent::Type::Key:
+		UpdateInputStateFrame();
+		m_inputState.SetKeyState(ev.key.key, ev.key.state);
+		break;
+	case InputEvent::Type::MouseButton:
+		UpdateInputStateFrame();
+		m_inputState.SetMouseButtonState(ev.mouseButton.button, ev.mouseButton.state);
+		break;
+	case InputEvent::Type::CursorPos:
+		{
+			Vector2 pos {ev.cursorPos.x, ev.cursorPos.y};
+			auto delta = m_lastCursorPos ? (pos - *m_lastCursorPos) : Vector2 {};
+			m_lastCursorPos = pos;
+			if(m_coalescedInput) {
+				auto &coalesced = *m_coalescedInput;
+				// The history only contains the samples of a single input frame
+				if(coalesced.historyFrame != detail::get_input_frame_index()) {
+					coalesced.cursorHistory.clear();
+					coalesced.historyFrame = detail::get_input_frame_index();
+				}
+				if(m_cursorHistoryEnabled)
+					coalesced.cursorHistory.push_back(pos);
+				coalesced.cursorPos = pos;
+				coalesced.cursorDelta += delta;
+				coalesced.cursorTime = ev.time;
+				coalesced.cursorPending = true;
+				RequestPoll();
+				return;
+			}
+			ev.cursorPos.deltaX = delta.x;
+			ev.cursorPos.deltaY = delta.y;
+			break;
+		}
+	case InputEvent::Type::Scroll:
+		if(m_coalescedInput) {
+			auto &coalesced = *m_coalescedInput;
+			coalesced.scrollX += ev.scroll.x;
+			coalesced.scrollY += ev.scroll.y;
+			coalesced.scrollTime = ev.time;
+			coalesced.scrollPending = true;
+			RequestPoll();
+			return;
+		}
+		break;
+	default:
+		break;
+	}
+	// Any pending coalesced input has to be delivered first to retain the event order,
+	// e.g. so that a mouse click is handled at the correct cursor position
+	if(m_coalescedInput)
+		FlushCoalescedInput();
+	ProcessEvent(ev);
+}
+
+void pragma::platform::Window::ProcessEvent(const InputEvent &ev)
+{
+	if(is_input_statistics_enabled())
+		detail::record_input_event(ev.type);
+	if(m_inputChannel)
+		m_inputChannel->Push(ev);
+	if(m_eventQueue) {
+		m_eventQueue->Push(ev);
+		return;
+	}
+	DispatchEvent(ev);
+}
+
+void pragma::platform::Window::DispatchEvent(const InputEvent &ev)
+{
+	m_eventTime = ev.time;
+	if(is_input_statistics_enabled()) {
+		auto t = std::chrono::steady_clock::now();
+		InvokeEventCallback(ev);
+		auto dt = std::chrono::steady_clock::now() - t;
+		detail::record_input_dispatch(ev, std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+		return;
+	}
+	InvokeEventCallback(ev);
+}
+
+void pragma::platform::Window::InvokeEventCallback(const InputEvent &ev)
+{
+	switch(ev.type) {
+	case InputEvent::Type::Key:
+		// Pending text has to be delivered first, otherwise e.g. a backspace or enter key would be handled before the text that was typed before it
+		FlushTextInput();
+		if(DispatchListeners<WindowEvent::Key>(ev.key.key, ev.key.scancode, ev.key.state, ev.key.mods) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.keyCallback != nullptr)
+			m_callbackInterface.keyCallback(*this, ev.key.key, ev.key.scancode, ev.key.state, ev.key.mods);
+		break;
+	case InputEvent::Type::Char:
+		if(m_textInputBatch) {
+			// Delivered with the other characters of the same poll by FlushTextInput
+			m_textInputBatch->codepoints.push_back(ev.character.codepoint);
+			RequestPoll();
+			break;
+		}
+		if(DispatchListeners<WindowEvent::Char>(ev.character.codepoint) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.charCallback != nullptr)
+			m_callbackInterface.charCallback(*this, ev.character.codepoint);
+		break;
+	case InputEvent::Type::CharMods:
+		if(DispatchListeners<WindowEvent::CharMods>(ev.character.codepoint, ev.character.mods) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.charModsCallback != nullptr)
+			m_callbackInterface.charModsCallback(*this, ev.character.codepoint, ev.character.mods);
+		break;
+	case InputEvent::Type::MouseButton:
+		FlushTextInput();
+		if(DispatchListeners<WindowEvent::MouseButton>(ev.mouseButton.button, ev.mouseButton.state, ev.mouseButton.mods) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.mouseButtonCallback != nullptr)
+			m_callbackInterface.mouseButtonCallback(*this, ev.mouseButton.button, ev.mouseButton.state, ev.mouseButton.mods);
+		break;
+	case InputEvent::Type::Scroll:
+		if(DispatchListeners<WindowEvent::Scroll>(Vector2(ev.scroll.x, ev.scroll.y)) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.scrollCallback != nullptr)
+			m_callbackInterface.scrollCallback(*this, Vector2(ev.scroll.x, ev.scroll.y));
+		break;
+	case InputEvent::Type::CursorPos:
+		m_cursorDelta = {ev.cursorPos.deltaX, ev.cursorPos.deltaY};
+		if(DispatchListeners<WindowEvent::CursorPos>(Vector2(ev.cursorPos.x, ev.cursorPos.y)) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.cursorPosCallback != nullptr)
+			m_callbackInterface.cursorPosCallback(*this, Vector2(ev.cursorPos.x, ev.cursorPos.y));
+		break;
+	case InputEvent::Type::CursorEnter:
+		if(DispatchListeners<WindowEvent::CursorEnter>(ev.cursorEnter.value) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.cursorEnterCallback != nullptr)
+			m_callbackInterface.cursorEnterCallback(*this, ev.cursorEnter.value);
+		break;
+	case InputEvent::Type::Focus:
+		if(DispatchListeners<WindowEvent::Focus>(ev.focus.value) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.focusCallback != nullptr)
+			m_callbackInterface.focusCallback(*this, ev.focus.value);
+		break;
+	case InputEvent::Type::Iconify:
+		if(DispatchListeners<WindowEvent::Iconify>(ev.iconify.value) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.iconifyCallback != nullptr)
+			m_callbackInterface.iconifyCallback(*this, ev.iconify.value);
+		break;
+	case InputEvent::Type::Resize:
+		if(DispatchListeners<WindowEvent::Resize>(Vector2i(ev.resize.x, ev.resize.y)) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.resizeCallback != nullptr)
+			m_callbackInterface.resizeCallback(*this, Vector2i(ev.resize.x, ev.resize.y));
+		break;
+	case InputEvent::Type::WindowPos:
+		if(DispatchListeners<WindowEvent::WindowPos>(Vector2i(ev.windowPos.x, ev.windowPos.y)) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.windowPosCallback != nullptr)
+			m_callbackInterface.windowPosCallback(*this, Vector2i(ev.windowPos.x, ev.windowPos.y));
+		break;
+	case InputEvent::Type::WindowSize:
+		if(DispatchListeners<WindowEvent::WindowSize>(Vector2i(ev.windowSize.x, ev.windowSize.y)) == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.windowSizeCallback != nullptr)
+			m_callbackInterface.windowSizeCallback(*this, Vector2i(ev.windowSize.x, ev.windowSize.y));
+		break;
+	case InputEvent::Type::DragEnter:
+		if(DispatchListeners<WindowEvent::DragEnter>() == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.dragEnterCallback != nullptr)
+			m_callbackInterface.dragEnterCallback(*this);
+		break;
+	case InputEvent::Type::DragExit:
+		if(DispatchListeners<WindowEvent::DragExit>() == ListenerResult::Consume)
+			break;
+		if(m_callbackInterface.dragExitCallback != nullptr)
+			m_callbackInterface.dragExitCallback(*this);
+		break;
+	case InputEvent::Type::Drop:
+		// Drop events carry their paths separately, see DropCallback and DispatchQueuedEvents
+		break;
+	default:
+		break;
+	}
+	static_assert(math::to_integral(InputEvent::Type::Count) == 15, "Update this list when new event types are added!");
+}
+
 void pragma::platform::Window::KeyCallback(int key, int scancode, int action, int mods)
 {
-	if(m_callbackInterface.keyCallback != nullptr)
-		m_callbackInterface.keyCallback(*this, static_cast<Key>(key), scancode, static_cast<KeyState>(action), static_cast<Modifier>(mods));
+	InputEvent ev {InputEvent::Type::Key};
+	ev.key = {static_cast<Key>(key), scancode, static_cast<KeyState>(action), static_cast<Modifier>(mods)};
+	HandleEvent(ev);
 }
 
 void pragma::platform::Window::RefreshCallback()
 {
+	if(DispatchListeners<WindowEvent::Refresh>() == ListenerResult::Consume)
+		return;
 	if(m_callbackInterface.refreshCallback != nullptr)
 		m_callbackInterface.refreshCallback(*this);
 }
 
 void pragma::platform::Window::ResizeCallback(int width, int height)
 {
-	if(m_callbackInterface.resizeCallback != nullptr)
-		m_callbackInterface.resizeCallback(*this, Vector2i(width, height));
+	InputEvent ev {InputEvent::Type::Resize};
+	ev.resize = {width, height};
+	HandleEvent(ev);
 }
 
 void pragma::platform::Window::CharCallback(unsigned int c)
 {
-	if(m_callbackInterface.charCallback != nullptr)
-		m_callbackInterface.charCallback(*this, c);
+	InputEvent ev {InputEvent::Type::Char};
+	ev.character = {c, Modifier::None};
+	HandleEvent(ev);
 }
 void pragma::platform::Window::CharModsCallback(unsigned int c, int mods)
 {
-	if(m_callbackInterface.charModsCallback != nullptr)
-		m_callbackInterface.charModsCallback(*this, c, static_cast<Modifier>(mods));
+	InputEvent ev {InputEvent::Type::CharMods};
+	ev.character = {c, static_cast<Modifier>(mods)};
+	HandleEvent(ev);
 }
 void pragma::platform::Window::CursorEnterCallback(int e)
 {
-	if(m_callbackInterface.cursorEnterCallback != nullptr)
-		m_callbackInterface.cursorEnterCallback(*this, (e == GLFW_TRUE) ? true : false);
+	InputEvent ev {InputEvent::Type::CursorEnter};
+	ev.cursorEnter.value = (e == GLFW_TRUE) ? true : false;
+	HandleEvent(ev);
 }
 void pragma::platform::Window::CursorPosCallback(double x, double y)
 {
-	if(m_callbackInterface.cursorPosCallback != nullptr)
-		m_callbackInterface.cursorPosCallback(*this, Vector2(x, y));
+	m_attributes.cursorPos = {static_cast<float>(x), static_cast<float>(y)};
+	InputEvent ev {InputEvent::Type::CursorPos};
+	ev.cursorPos = {static_cast<float>(x), static_cast<float>(y), 0.f, 0.f};
+	HandleEvent(ev);
+}
+void pragma::platform::Window::DropCallback(int count, const char **paths) { CaptureDrop(count, paths, get_time()); }
+void pragma::platform::Window::InjectDrop(const std::vector<std::string> &paths, double time)
+{
+	std::vector<const char *> cpaths;
+	cpaths.reserve(paths.size());
+	for(auto &path : paths)
+		cpaths.push_back(path.c_str());
+	CaptureDrop(static_cast<int>(cpaths.size()), cpaths.data(), time);
+}
+void pragma::platform::Window::CaptureDrop(int count, const char **paths, double time)
+{
+	if(m_inputRecorder)
+		m_inputRecorder->RecordDrop(count, paths, time);
+	if(m_coalescedInput)
+		FlushCoalescedInput();
+	if(is_input_statistics_enabled())
+		detail::record_input_event(InputEvent::Type::Drop);
+	if(m_dropPrefetchCallback) {
+		DropPathList prefetchPaths;
+		prefetchPaths.Assign(count, paths);
+		auto job = std::make_shared<detail::DropPrefetchJob>(std::move(prefetchPaths), m_dropPrefetchSize);
+		detail::submit_drop_prefetch_job(job);
+		m_dropPrefetchJobs.push_back(job);
+		RequestPoll();
+	}
+	if(m_eventQueue) {
+		m_eventQueue->PushDrop(count, paths, time);
+		return;
+	}
+	m_eventTime = time;
+	if(m_callbackInterface.dropCallback == nullptr && m_callbackInterface.dropPathsCallback == nullptr && !HasListeners(WindowEvent::Drop))
+		return;
+	m_dropPaths.Assign(count, paths);
+	DispatchDrop(m_dropPaths);
 }
-void pragma::platform::Window::DropCallback(int count, const char **paths)
+void pragma::platform::Window::DispatchDrop(const DropPathList &paths)
 {
+	if(DispatchListeners<WindowEvent::Drop>(paths.GetPaths()) == ListenerResult::Consume)
+		return;
+	if(m_callbackInterface.dropPathsCallback != nullptr)
+		m_callbackInterface.dropPathsCallback(*this, paths.GetPaths());
 	if(m_callbackInterface.dropCallback != nullptr) {
 		std::vector<std::string> files;
-		files.reserve(count);
-		for(auto i = decltype(count) {0}; i < count; ++i)
-			files.push_back(paths[i]);
+		files.reserve(paths.GetCount());
+		for(auto &path : paths.GetPaths())
+			files.emplace_back(path);
 		m_callbackInterface.dropCallback(*this, files);
 	}
 }
-void pragma::platform::Window::DragEnterCallback()
+void pragma::platform::Window::SetDropPrefetchCallback(const std::function<void(Window &, std::span<const DroppedFile>)> &callback, size_t prefetchSize)
 {
-	if(m_callbackInterface.dragEnterCallback != nullptr)
-		m_callbackInterface.dragEnterCallback(*this);
-}
-void pragma::platform::Window::DragExitCallback()
-{
-	if(m_callbackInterface.dragExitCallback != nullptr)
-		m_callbackInterface.dragExitCallback(*this);
+	m_dropPrefetchCallback = callback;
+	m_dropPrefetchSize = prefetchSize;
+	if(!callback)
+		m_dropPrefetchJobs.clear();
+	UpdateCallbackHooks();
 }
+void pragma::platform::Window::DragEnterCallback() { HandleEvent(InputEvent {InputEvent::Type::DragEnter}); }
+void pragma::platform::Window::DragExitCallback() { HandleEvent(InputEvent {InputEvent::Type::DragExit}); }
 void pragma::platform::Window::MouseButtonCallback(int button, int action, int mods)
 {
-	if(m_callbackInterface.mouseButtonCallback != nullptr)
-		m_callbackInterface.mouseButtonCallback(*this, static_cast<MouseButton>(button), static_cast<KeyState>(action), static_cast<Modifier>(mods));
+	InputEvent ev {InputEvent::Type::MouseButton};
+	ev.mouseButton = {static_cast<MouseButton>(button), static_cast<KeyState>(action), static_cast<Modifier>(mods)};
+	HandleEvent(ev);
 }
 void pragma::platform::Window::ScrollCallback(double xoffset, double yoffset)
 {
-	if(m_callbackInterface.scrollCallback != nullptr)
-		m_callbackInterface.scrollCallback(*this, Vector2(xoffset, yoffset));
+	InputEvent ev {InputEvent::Type::Scroll};
+	ev.scroll = {xoffset, yoffset};
+	HandleEvent(ev);
+}
+void pragma::platform::Window::FlushCoalescedInput()
+{
+	auto &coalesced = *m_coalescedInput;
+	auto flushCursor = [this, &coalesced]() {
+		if(!coalesced.cursorPending)
+			return;
+		coalesced.cursorPending = false;
+		InputEvent ev {InputEvent::Type::CursorPos, coalesced.cursorTime};
+		ev.cursorPos = {coalesced.cursorPos.x, coalesced.cursorPos.y, coalesced.cursorDelta.x, coalesced.cursorDelta.y};
+		coalesced.cursorDelta = {};
+		ProcessEvent(ev);
+	};
+	auto flushScroll = [this, &coalesced]() {
+		if(!coalesced.scrollPending)
+			return;
+		coalesced.scrollPending = false;
+		InputEvent ev {InputEvent::Type::Scroll, coalesced.scrollTime};
+		ev.scroll = {coalesced.scrollX, coalesced.scrollY};
+		coalesced.scrollX = 0.0;
+		coalesced.scrollY = 0.0;
+		ProcessEvent(ev);
+	};
+	// Keep the events ordered by capture time
+	if(coalesced.scrollPending && coalesced.cursorPending && coalesced.scrollTime < coalesced.cursorTime) {
+		flushScroll();
+		flushCursor();
+		return;
+	}
+	flushCursor();
+	flushScroll();
 }
 void pragma::platform::Window::FocusCallback(int focused)
 {
-	if(m_callbackInterface.focusCallback != nullptr)
-		m_callbackInterface.focusCallback(*this, (focused == GLFW_TRUE) ? true : false);
+	// Another application may have changed the clipboard while none of our windows had focus
+	g_clipboardCache.valid = false;
+	m_attributes.focused = (focused == GLFW_TRUE);
+	InputEvent ev {InputEvent::Type::Focus};
+	ev.focus.value = (focused == GLFW_TRUE) ? true : false;
+	HandleEvent(ev);
 }
 void pragma::platform::Window::IconifyCallback(int iconified)
 {
-	if(m_callbackInterface.iconifyCallback != nullptr)
-		m_callbackInterface.iconifyCallback(*this, (iconified == GLFW_TRUE) ? true : false);
+	m_attributes.iconified = (iconified == GLFW_TRUE);
+	InputEvent ev {InputEvent::Type::Iconify};
+	ev.iconify.value = (iconified == GLFW_TRUE) ? true : false;
+	HandleEvent(ev);
 }
 void pragma::platform::Window::WindowPosCallback(int x, int y)
 {
-	if(m_callbackInterface.windowPosCallback != nullptr)
-		m_callbackInterface.windowPosCallback(*this, Vector2i(x, y));
+	m_attributes.pos = {x, y};
+	InputEvent ev {InputEvent::Type::WindowPos};
+	ev.windowPos = {x, y};
+	HandleEvent(ev);
 }
 void pragma::platform::Window::WindowSizeCallback(int w, int h)
 {
-	if(m_callbackInterface.windowSizeCallback != nullptr)
-		m_callbackInterface.windowSizeCallback(*this, Vector2i(w, h));
+	m_attributes.size = {w, h};
+	m_attributes.frameSize = {};
+	InputEvent ev {InputEvent::Type::WindowSize};
+	ev.windowSize = {w, h};
+	HandleEvent(ev);
+}
+void pragma::platform::Window::FramebufferSizeCallback(int w, int h) { m_attributes.framebufferSize = {w, h}; }
+void pragma::platform::Window::MaximizeCallback(int maximized)
+{
+	m_attributes.maximized = (maximized == GLFW_TRUE);
+	m_attributes.frameSize = {};
 }
 void pragma::platform::Window::PreeditCallback(int preedit_count, unsigned int *preedit_string, int block_count, int *block_sizes, int focused_block, int caret)
 {
+	FlushTextInput();
+	if(m_callbackInterface.preeditTextCallback != nullptr || HasListeners(WindowEvent::PreeditText)) {
+		static_assert(sizeof(unsigned int) == sizeof(uint32_t));
+		std::span<const uint32_t> codepoints {};
+		if(preedit_string && preedit_count > 0)
+			codepoints = {reinterpret_cast<const uint32_t *>(preedit_string), static_cast<size_t>(preedit_count)};
+		// The storage is reused, so no allocations are required once it is large enough
+		auto &storage = m_preeditText;
+		storage.text.clear();
+		detail::encode_utf8(codepoints, storage.text);
+		storage.blocks.clear();
+		size_t codepointOffset = 0;
+		size_t byteOffset = 0;
+		for(auto i = decltype(block_count) {0}; i < block_count; ++i) {
+			auto blockSize = std::min(static_cast<size_t>(std::max(block_sizes[i], 0)), codepoints.size() - codepointOffset);
+			auto length = detail::get_utf8_length(codepoints.subspan(codepointOffset, blockSize));
+			storage.blocks.emplace_back(storage.text.data() + byteOffset, length);
+			codepointOffset += blockSize;
+			byteOffset += length;
+		}
+		PreeditText text {};
+		text.text = storage.text;
+		text.blocks = storage.blocks;
+		text.focusedBlock = focused_block;
+		text.caret = detail::get_utf8_length(codepoints.first(std::min(static_cast<size_t>(std::max(caret, 0)), codepoints.size())));
+		if(DispatchListeners<WindowEvent::PreeditText>(text) != ListenerResult::Consume && m_callbackInterface.preeditTextCallback != nullptr)
+			m_callbackInterface.preeditTextCallback(*this, text);
+	}
+	if(DispatchListeners<WindowEvent::Preedit>(preedit_count, preedit_string, block_count, block_sizes, focused_block, caret) == ListenerResult::Consume)
+		return;
 	if(m_callbackInterface.preeditCallback != nullptr)
 		m_callbackInterface.preeditCallback(*this, preedit_count, preedit_string, block_count, block_sizes, focused_block, caret);
 }
 void pragma::platform::Window::IMEStatusCallback()
 {
+	if(DispatchListeners<WindowEvent::IMEStatus>() == ListenerResult::Consume)
+		return;
 	if(m_callbackInterface.imeStatusCallback != nullptr)
 		m_callbackInterface.imeStatusCallback(*this);
 }
@@ -163,51 +523,288 @@ void pragma::platform::Window::MakeContextCurrent() const
 const GLFWwindow *pragma::platform::Window::GetGLFWWindow() const { return m_window; }
 
 void pragma::platform::Window::SetKeyCallback(const std::function<void(Window &, Key, int, KeyState, Modifier)> &callback) { m_callbackInterface.keyCallback = callback; }
-void pragma::platform::Window::SetRefreshCallback(const std::function<void(Window &)> &callback) { m_callbackInterface.refreshCallback = callback; }
+void pragma::platform::Window::SetRefreshCallback(const std::function<void(Window &)> &callback)
+{
+	m_callbackInterface.refreshCallback = callback;
+	UpdateCallbackHooks();
+}
 void pragma::platform::Window::SetResizeCallback(const std::function<void(Window &, Vector2i)> &callback) { m_callbackInterface.resizeCallback = callback; }
-void pragma::platform::Window::SetCharCallback(const std::function<void(Window &, unsigned int)> &callback) { m_callbackInterface.charCallback = callback; }
-void pragma::platform::Window::SetCharModsCallback(const std::function<void(Window &, unsigned int, Modifier)> &callback) { m_callbackInterface.charModsCallback = callback; }
-void pragma::platform::Window::SetCursorEnterCallback(const std::function<void(Window &, bool)> &callback) { m_callbackInterface.cursorEnterCallback = callback; }
+void pragma::platform::Window::SetCharCallback(const std::function<void(Window &, unsigned int)> &callback)
+{
+	m_callbackInterface.charCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetCharModsCallback(const std::function<void(Window &, unsigned int, Modifier)> &callback)
+{
+	m_callbackInterface.charModsCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetCursorEnterCallback(const std::function<void(Window &, bool)> &callback)
+{
+	m_callbackInterface.cursorEnterCallback = callback;
+	UpdateCallbackHooks();
+}
 void pragma::platform::Window::SetCursorPosCallback(const std::function<void(Window &, Vector2)> &callback) { m_callbackInterface.cursorPosCallback = callback; }
-void pragma::platform::Window::SetDropCallback(const std::function<void(Window &, std::vector<std::string> &)> &callback) { m_callbackInterface.dropCallback = callback; }
-void pragma::platform::Window::SetDragEnterCallback(const std::function<void(Window &)> &callback) { m_callbackInterface.dragEnterCallback = callback; }
-void pragma::platform::Window::SetDragExitCallback(const std::function<void(Window &)> &callback) { m_callbackInterface.dragExitCallback = callback; }
+void pragma::platform::Window::SetDropCallback(const std::function<void(Window &, std::vector<std::string> &)> &callback)
+{
+	m_callbackInterface.dropCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetDropPathsCallback(const std::function<void(Window &, std::span<const std::string_view>)> &callback)
+{
+	m_callbackInterface.dropPathsCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetDragEnterCallback(const std::function<void(Window &)> &callback)
+{
+	m_callbackInterface.dragEnterCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetDragExitCallback(const std::function<void(Window &)> &callback)
+{
+	m_callbackInterface.dragExitCallback = callback;
+	UpdateCallbackHooks();
+}
 void pragma::platform::Window::SetMouseButtonCallback(const std::function<void(Window &, MouseButton, KeyState, Modifier)> &callback) { m_callbackInterface.mouseButtonCallback = callback; }
-void pragma::platform::Window::SetScrollCallback(const std::function<void(Window &, Vector2)> &callback) { m_callbackInterface.scrollCallback = callback; }
+void pragma::platform::Window::SetScrollCallback(const std::function<void(Window &, Vector2)> &callback)
+{
+	m_callbackInterface.scrollCallback = callback;
+	UpdateCallbackHooks();
+}
 void pragma::platform::Window::SetCloseCallback(const std::function<void(Window &)> &callback) { m_callbackInterface.closeCallback = callback; }
 void pragma::platform::Window::SetFocusCallback(const std::function<void(Window &, bool)> &callback) { m_callbackInterface.focusCallback = callback; }
 void pragma::platform::Window::SetIconifyCallback(const std::function<void(Window &, bool)> &callback) { m_callbackInterface.iconifyCallback = callback; }
 void pragma::platform::Window::SetWindowPosCallback(const std::function<void(Window &, Vector2i)> &callback) { m_callbackInterface.windowPosCallback = callback; }
 void pragma::platform::Window::SetWindowSizeCallback(const std::function<void(Window &, Vector2i)> &callback) { m_callbackInterface.windowSizeCallback = callback; }
-void pragma::platform::Window::SetPreeditCallback(const std::function<void(Window &, int, unsigned int *, int, int *, int, int)> &callback) { m_callbackInterface.preeditCallback = callback; }
-void pragma::platform::Window::SetIMEStatusCallback(const std::function<void(Window &)> &callback) { m_callbackInterface.imeStatusCallback = callback; }
+void pragma::platform::Window::SetPreeditCallback(const std::function<void(Window &, int, unsigned int *, int, int *, int, int)> &callback)
+{
+	m_callbackInterface.preeditCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetIMEStatusCallback(const std::function<void(Window &)> &callback)
+{
+	m_callbackInterface.imeStatusCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetTextInputCallback(const std::function<void(Window &, std::string_view)> &callback)
+{
+	m_callbackInterface.textInputCallback = callback;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetPreeditTextCallback(const std::function<void(Window &, const PreeditText &)> &callback)
+{
+	m_callbackInterface.preeditTextCallback = callback;
+	UpdateCallbackHooks();
+}
 void pragma::platform::Window::SetOnShouldCloseCallback(const std::function<bool(Window &)> &callback) { m_callbackInterface.onShouldClose = callback; }
-void pragma::platform::Window::SetCallbacks(const CallbackInterface &callbacks) { m_callbackInterface = callbacks; }
+void pragma::platform::Window::SetCallbacks(const CallbackInterface &callbacks)
+{
+	m_callbackInterface = callbacks;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::SetCallbacks(CallbackInterface &&callbacks)
+{
+	m_callbackInterface = std::move(callbacks);
+	UpdateCallbackHooks();
+}
 const pragma::platform::CallbackInterface &pragma::platform::Window::GetCallbacks() const { return m_callbackInterface; }
 
+void pragma::platform::Window::SetEventQueueEnabled(bool enabled)
+{
+	if(enabled == IsEventQueueEnabled())
+		return;
+	if(!enabled) {
+		// Make sure no events get lost
+		DispatchQueuedEvents();
+		m_eventQueue = nullptr;
+		UpdateCallbackHooks();
+		return;
+	}
+	m_eventQueue = std::make_unique<InputEventQueue>();
+	UpdateCallbackHooks();
+}
+bool pragma::platform::Window::IsEventQueueEnabled() const { return m_eventQueue != nullptr; }
+pragma::platform::InputEventQueue *pragma::platform::Window::GetEventQueue() { return m_eventQueue.get(); }
+void pragma::platform::Window::SetInputCoalescingEnabled(bool enabled)
+{
+	if(enabled == IsInputCoalescingEnabled())
+		return;
+	if(!enabled) {
+		FlushCoalescedInput();
+		m_coalescedInput = nullptr;
+		return;
+	}
+	m_coalescedInput = std::make_unique<CoalescedInput>();
+}
+bool pragma::platform::Window::IsInputCoalescingEnabled() const { return m_coalescedInput != nullptr; }
+void pragma::platform::Window::SetTextInputBatchingEnabled(bool enabled)
+{
+	if(enabled == IsTextInputBatchingEnabled())
+		return;
+	if(!enabled) {
+		FlushTextInput();
+		m_textInputBatch = nullptr;
+	}
+	else
+		m_textInputBatch = std::make_unique<TextInputBatch>();
+	UpdateCallbackHooks();
+}
+bool pragma::platform::Window::IsTextInputBatchingEnabled() const { return m_textInputBatch != nullptr; }
+void pragma::platform::Window::FlushTextInput()
+{
+	if(!m_textInputBatch || m_textInputBatch->codepoints.empty())
+		return;
+	auto &batch = *m_textInputBatch;
+	if(batch.dispatching) {
+		// The text is still in use by a callback, the new characters are delivered with the next poll
+		RequestPoll();
+		return;
+	}
+	batch.text.clear();
+	detail::encode_utf8(batch.codepoints, batch.text);
+	batch.codepoints.clear();
+	batch.dispatching = true;
+	std::string_view text {batch.text};
+	if(DispatchListeners<WindowEvent::TextInput>(text) != ListenerResult::Consume && m_callbackInterface.textInputCallback != nullptr)
+		m_callbackInterface.textInputCallback(*this, text);
+	// The batch may have been disabled by a callback
+	if(m_textInputBatch)
+		m_textInputBatch->dispatching = false;
+}
+void pragma::platform::Window::SetCursorHistoryEnabled(bool enabled)
+{
+	m_cursorHistoryEnabled = enabled;
+	if(!enabled && m_coalescedInput)
+		m_coalescedInput->cursorHistory = {};
+}
+bool pragma::platform::Window::IsCursorHistoryEnabled() const { return m_cursorHistoryEnabled; }
+std::span<const Vector2> pragma::platform::Window::GetCursorHistory() const
+{
+	// The history is discarded lazily once it is older than the last completed input frame
+	if(!m_coalescedInput || m_coalescedInput->historyFrame + 1 < detail::get_input_frame_index())
+		return {};
+	return m_coalescedInput->cursorHistory;
+}
+const Vector2 &pragma::platform::Window::GetCursorDelta() const { return m_cursorDelta; }
+double pragma::platform::Window::GetEventTime() const { return m_eventTime; }
+
+void pragma::platform::Window::SetInputRecorder(const std::shared_ptr<InputRecorder> &recorder)
+{
+	m_inputRecorder = recorder;
+	UpdateCallbackHooks();
+}
+const std::shared_ptr<pragma::platform::InputRecorder> &pragma::platform::Window::GetInputRecorder() const { return m_inputRecorder; }
+
+std::shared_ptr<pragma::platform::InputChannel> pragma::platform::Window::CreateInputChannel(uint32_t capacity)
+{
+	m_inputChannel = std::make_shared<InputChannel>(capacity);
+	UpdateCallbackHooks();
+	return m_inputChannel;
+}
+const std::shared_ptr<pragma::platform::InputChannel> &pragma::platform::Window::GetInputChannel() const { return m_inputChannel; }
+void pragma::platform::Window::ClearInputChannel()
+{
+	m_inputChannel = nullptr;
+	UpdateCallbackHooks();
+}
+void pragma::platform::Window::DispatchQueuedEvents()
+{
+	if(!m_eventQueue)
+		return;
+	m_eventQueue->Drain([this](const InputEvent &ev) {
+		if(ev.type != InputEvent::Type::Drop) {
+			DispatchEvent(ev);
+			return;
+		}
+		if(m_callbackInterface.dropCallback == nullptr && m_callbackInterface.dropPathsCallback == nullptr && !HasListeners(WindowEvent::Drop))
+			return;
+		// Move the paths out of the queue, in case the callback causes new events to be queued
+		auto paths = std::move(m_eventQueue->GetDropPathList(ev));
+		DispatchDrop(paths);
+	});
+	FlushTextInput();
+}
+
 bool pragma::platform::Window::ShouldClose() const { return (glfwWindowShouldClose(const_cast<GLFWwindow *>(GetGLFWWindow())) == GLFW_TRUE) ? true : false; }
-void pragma::platform::Window::SetShouldClose(bool b) { glfwSetWindowShouldClose(const_cast<GLFWwindow *>(GetGLFWWindow()), (b == true) ? GLFW_TRUE : GLFW_FALSE); }
+void pragma::platform::Window::SetShouldClose(bool b)
+{
+	glfwSetWindowShouldClose(const_cast<GLFWwindow *>(GetGLFWWindow()), (b == true) ? GLFW_TRUE : GLFW_FALSE);
+	if(b)
+		RequestPoll();
+}
 
-pragma::platform::KeyState pragma::platform::Window::GetKeyState(Key key) { return static_cast<KeyState>(glfwGetKey(const_cast<GLFWwindow *>(GetGLFWWindow()), static_cast<uint32_t>(key))); }
-pragma::platform::KeyState pragma::platform::Window::GetMouseButtonState(MouseButton button) { return static_cast<KeyState>(glfwGetMouseButton(const_cast<GLFWwindow *>(GetGLFWWindow()), static_cast<uint32_t>(button))); }
+pragma::platform::KeyState pragma::platform::Window::GetKeyState(Key key)
+{
+	// Sticky keys change the semantics of glfwGetKey, so we can't use the tracked state in that case
+	if(m_stickyKeys)
+		return static_cast<KeyState>(glfwGetKey(const_cast<GLFWwindow *>(GetGLFWWindow()), static_cast<uint32_t>(key)));
+	return IsKeyDown(key) ? KeyState::Press : KeyState::Release;
+}
+pragma::platform::KeyState pragma::platform::Window::GetMouseButtonState(MouseButton button)
+{
+	if(m_stickyMouseButtons)
+		return static_cast<KeyState>(glfwGetMouseButton(const_cast<GLFWwindow *>(GetGLFWWindow()), static_cast<uint32_t>(button)));
+	return IsMouseButtonDown(button) ? KeyState::Press : KeyState::Release;
+}
 
-std::string pragma::platform::Window::GetClipboardString() const
+// The input state is rolled over lazily on the first input event of a new frame, so that poll_events()
+// doesn't have to touch windows without input.
+// The state is current if it belongs to the last completed frame, or to the frame that input is currently being received for
+// (e.g. when queried from an input callback).
+bool pragma::platform::Window::IsInputStateCurrent() const { return m_inputStateFrame + 1 >= detail::get_input_frame_index(); }
+void pragma::platform::Window::UpdateInputStateFrame()
 {
-	auto *str = glfwGetClipboardString(const_cast<GLFWwindow *>(GetGLFWWindow()));
-	if(!str)
-		return {};
-	return str;
+	if(m_inputStateFrame == detail::get_input_frame_index())
+		return;
+	m_inputStateFrame = detail::get_input_frame_index();
+	m_inputState.RollOver();
+}
+static bool is_valid_key(pragma::platform::Key key) { return pragma::math::to_integral(key) >= 0 && static_cast<size_t>(key) < pragma::platform::InputState::KEY_COUNT; }
+static bool is_valid_mouse_button(pragma::platform::MouseButton button) { return pragma::math::to_integral(button) < pragma::platform::InputState::MOUSE_BUTTON_COUNT; }
+bool pragma::platform::Window::IsKeyDown(Key key) const { return is_valid_key(key) && m_inputState.current.keys.Test(math::to_integral(key)); }
+bool pragma::platform::Window::WasKeyPressed(Key key) const { return is_valid_key(key) && IsInputStateCurrent() && m_inputState.pressed.keys.Test(math::to_integral(key)); }
+bool pragma::platform::Window::WasKeyReleased(Key key) const { return is_valid_key(key) && IsInputStateCurrent() && m_inputState.released.keys.Test(math::to_integral(key)); }
+pragma::platform::KeyState pragma::platform::Window::GetKeyFrameState(Key key) const
+{
+	if(!is_valid_key(key))
+		return KeyState::Invalid;
+	auto idx = math::to_integral(key);
+	auto &previous = IsInputStateCurrent() ? m_inputState.previous : m_inputState.current;
+	return InputState::GetFrameState(m_inputState.current.keys.Test(idx), previous.keys.Test(idx));
+}
+bool pragma::platform::Window::IsMouseButtonDown(MouseButton button) const { return is_valid_mouse_button(button) && m_inputState.current.mouseButtons.Test(math::to_integral(button)); }
+bool pragma::platform::Window::WasMouseButtonPressed(MouseButton button) const { return is_valid_mouse_button(button) && IsInputStateCurrent() && m_inputState.pressed.mouseButtons.Test(math::to_integral(button)); }
+bool pragma::platform::Window::WasMouseButtonReleased(MouseButton button) const { return is_valid_mouse_button(button) && IsInputStateCurrent() && m_inputState.released.mouseButtons.Test(math::to_integral(button)); }
+pragma::platform::KeyState pragma::platform::Window::GetMouseButtonFrameState(MouseButton button) const
+{
+	if(!is_valid_mouse_button(button))
+		return KeyState::Invalid;
+	auto idx = math::to_integral(button);
+	auto &previous = IsInputStateCurrent() ? m_inputState.previous : m_inputState.current;
+	return InputState::GetFrameState(m_inputState.current.mouseButtons.Test(idx), previous.mouseButtons.Test(idx));
+}
+pragma::platform::InputState pragma::platform::Window::GetInputState() const
+{
+	auto state = m_inputState;
+	if(!IsInputStateCurrent())
+		state.RollOver();
+	return state;
+}
+
+std::string pragma::platform::Window::GetClipboardString() const { return std::string {GetClipboardStringView()}; }
+std::string_view pragma::platform::Window::GetClipboardStringView() const { return *get_clipboard_contents(const_cast<GLFWwindow *>(GetGLFWWindow())); }
+void pragma::platform::Window::SetClipboardString(const std::string &str)
+{
+	glfwSetClipboardString(const_cast<GLFWwindow *>(GetGLFWWindow()), str.c_str());
+	g_clipboardCache.contents = std::make_shared<const std::string>(str);
+	g_clipboardCache.valid = true;
 }
-void pragma::platform::Window::SetClipboardString(const std::string &str) { glfwSetClipboardString(const_cast<GLFWwindow *>(GetGLFWWindow()), str.c_str()); }
 
 Vector2 pragma::platform::Window::GetCursorPos() const
 {
 	if(m_cursorPosOverride.has_value())
 		return *m_cursorPosOverride;
-	double x = 0.0;
-	double y = 0.0;
-	glfwGetCursorPos(const_cast<GLFWwindow *>(GetGLFWWindow()), &x, &y);
-	return Vector2(x, y);
+	return m_attributes.cursorPos;
 }
 void pragma::platform::Window::SetCursorPosOverride(const Vector2 &pos) { m_cursorPosOverride = pos; }
 void pragma::platform::Window::ClearCursorPosOverride() { m_cursorPosOverride = {}; }
@@ -215,20 +812,31 @@ bool pragma::platform::Window::SetCursorPos(const Vector2 &pos)
 {
 	glfwGetError(nullptr);
 	glfwSetCursorPos(const_cast<GLFWwindow *>(GetGLFWWindow()), pos.x, pos.y);
-	return glfwGetError(nullptr) == GLFW_NO_ERROR;
+	if(glfwGetError(nullptr) != GLFW_NO_ERROR)
+		return false;
+	m_attributes.cursorPos = pos;
+	return true;
 }
 void pragma::platform::Window::SetCursorInputMode(CursorMode mode) { return glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_CURSOR, static_cast<int>(mode)); }
 pragma::platform::CursorMode pragma::platform::Window::GetCursorInputMode() const { return static_cast<CursorMode>(glfwGetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_CURSOR)); }
-void pragma::platform::Window::SetStickyKeysEnabled(bool b) { return glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_KEYS, (b == true) ? GLFW_TRUE : GLFW_FALSE); }
-bool pragma::platform::Window::GetStickyKeysEnabled() const { return (glfwGetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_KEYS) == GLFW_TRUE) ? true : false; }
-void pragma::platform::Window::SetStickyMouseButtonsEnabled(bool b) { return glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_MOUSE_BUTTONS, (b == true) ? GLFW_TRUE : GLFW_FALSE); }
-bool pragma::platform::Window::GetStickyMouseButtonsEnabled() const { return (glfwGetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_MOUSE_BUTTONS) == GLFW_TRUE) ? true : false; }
+void pragma::platform::Window::SetStickyKeysEnabled(bool b)
+{
+	m_stickyKeys = b;
+	glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_KEYS, (b == true) ? GLFW_TRUE : GLFW_FALSE);
+}
+bool pragma::platform::Window::GetStickyKeysEnabled() const { return m_stickyKeys; }
+void pragma::platform::Window::SetStickyMouseButtonsEnabled(bool b)
+{
+	m_stickyMouseButtons = b;
+	glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_STICKY_MOUSE_BUTTONS, (b == true) ? GLFW_TRUE : GLFW_FALSE);
+}
+bool pragma::platform::Window::GetStickyMouseButtonsEnabled() const { return m_stickyMouseButtons; }
 void pragma::platform::Window::SetPreeditCursorRectangle(int32_t x, int32_t y, int32_t w, int32_t h) { glfwSetPreeditCursorRectangle(const_cast<GLFWwindow *>(GetGLFWWindow()), x, y, w, h); }
 void pragma::platform::Window::GetPreeditCursorRectangle(int32_t &outX, int32_t &outY, int32_t &outW, int32_t &outH) const { glfwGetPreeditCursorRectangle(const_cast<GLFWwindow *>(GetGLFWWindow()), &outX, &outY, &outW, &outH); }
 void pragma::platform::Window::ResetPreeditText() { glfwResetPreeditText(const_cast<GLFWwindow *>(GetGLFWWindow())); }
 void pragma::platform::Window::SetIMEEnabled(bool enabled) { return glfwSetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_IME, enabled ? GLFW_TRUE : GLFW_FALSE); }
 bool pragma::platform::Window::IsIMEEnabled() const { return (glfwGetInputMode(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_IME) == GLFW_TRUE) ? true : false; }
-bool pragma::platform::Window::IsInFocus() const { return glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_FOCUSED) == GLFW_TRUE; }
+bool pragma::platform::Window::IsInFocus() const { return m_attributes.focused; }
 
 void pragma::platform::Window::SetVSyncEnabled(bool enabled)
 {
@@ -254,15 +862,26 @@ void pragma::platform::Window::SetWindowIcon(uint32_t width, uint32_t height, co
 	glfwSetWindowIcon(const_cast<GLFWwindow *>(GetGLFWWindow()), 1, &iconData);
 	glfwGetError(nullptr); // Clear any errors that may have occurred
 }
-
-Vector2i pragma::platform::Window::GetPos() const
+void pragma::platform::Window::SetWindowIcon(const ImageView &image)
 {
-	int x = 0;
-	int y = 0;
-	glfwGetWindowPos(const_cast<GLFWwindow *>(GetGLFWWindow()), &x, &y);
-	return Vector2i(x, y);
+	auto icons = detail::get_icon_set(image);
+	if(!icons || icons->empty())
+		return;
+	std::array<GLFWimage, DEFAULT_ICON_SIZES.size()> images {};
+	auto count = std::min(icons->size(), images.size());
+	for(size_t i = 0; i < count; ++i) {
+		auto &icon = (*icons)[i];
+		images[i].width = icon.width;
+		images[i].height = icon.height;
+		images[i].pixels = const_cast<unsigned char *>(icon.pixels.data());
+	}
+	// Note: This won't work on Wayland, as Wayland does not support changing the window icon
+	glfwSetWindowIcon(const_cast<GLFWwindow *>(GetGLFWWindow()), static_cast<int>(count), images.data());
+	glfwGetError(nullptr); // Clear any errors that may have occurred
 }
 
+Vector2i pragma::platform::Window::GetPos() const { return m_attributes.pos; }
+
 void pragma::platform::Window::SetBorderColor(const Color &color)
 {
 	m_borderColor = color;
@@ -303,32 +922,48 @@ void pragma::platform::Window::SetTitleBarColor(const Color &color)
 std::optional<Color> pragma::platform::Window::GetTitleBarColor() const { return m_titleBarColor; }
 
 void pragma::platform::Window::SetPos(const Vector2i &pos) { glfwSetWindowPos(const_cast<GLFWwindow *>(GetGLFWWindow()), pos.x, pos.y); }
-Vector2i pragma::platform::Window::GetSize() const
+Vector2i pragma::platform::Window::GetSize() const { return m_attributes.size; }
+void pragma::platform::Window::SetSize(const Vector2i &size) { glfwSetWindowSize(const_cast<GLFWwindow *>(GetGLFWWindow()), size.x, size.y); }
+
+#ifdef __linux__
+void pragma::platform::Window::FinishWaylandDragAndDrop()
 {
-	int w = 0;
-	int h = 0;
-	glfwGetWindowSize(const_cast<GLFWwindow *>(GetGLFWWindow()), &w, &h);
-	return Vector2i(w, h);
+	if(!m_pendingWaylandDragAndDrop)
+		return;
+	auto info = std::move(m_pendingWaylandDragAndDrop);
+	// The paths are null-terminated, see DropPathList
+	std::vector<const char *> cpaths;
+	cpaths.reserve(info->files.GetCount());
+	for(auto &path : info->files.GetPaths())
+		cpaths.push_back(path.data());
+	DropCallback(cpaths.size(), cpaths.data());
+	DragExitCallback();
 }
-void pragma::platform::Window::SetSize(const Vector2i &size) { glfwSetWindowSize(const_cast<GLFWwindow *>(GetGLFWWindow()), size.x, size.y); }
+#endif
 
 void pragma::platform::Window::Poll()
 {
-#ifdef __linux__
-	if(m_pendingWaylandDragAndDrop) {
-		auto t = m_pendingWaylandDragAndDrop->t;
-		auto t2 = std::chrono::steady_clock::now();
-		if(t2 - t > std::chrono::milliseconds(100)) {
-			std::vector<const char *> cpaths;
-			cpaths.reserve(m_pendingWaylandDragAndDrop->files.size());
-			for(auto &path : m_pendingWaylandDragAndDrop->files)
-				cpaths.push_back(path.c_str());
-			DropCallback(cpaths.size(), cpaths.data());
-			DragExitCallback();
-			m_pendingWaylandDragAndDrop = {};
+	if(m_coalescedInput)
+		FlushCoalescedInput();
+	FlushTextInput();
+
+	if(m_animatedCursor)
+		UpdateCursorAnimation();
+
+	if(!m_dropPrefetchJobs.empty()) {
+		// Jobs are delivered in order, so a slow drop holds back the following ones
+		size_t numCompleted = 0;
+		while(numCompleted < m_dropPrefetchJobs.size() && m_dropPrefetchJobs[numCompleted]->IsComplete())
+			++numCompleted;
+		std::vector<std::shared_ptr<detail::DropPrefetchJob>> completed {m_dropPrefetchJobs.begin(), m_dropPrefetchJobs.begin() + numCompleted};
+		m_dropPrefetchJobs.erase(m_dropPrefetchJobs.begin(), m_dropPrefetchJobs.begin() + numCompleted);
+		if(!m_dropPrefetchJobs.empty())
+			RequestPoll();
+		for(auto &job : completed) {
+			if(m_dropPrefetchCallback)
+				m_dropPrefetchCallback(*this, job->GetFiles());
 		}
 	}
-#endif
 
 	if(!m_shouldCloseInvoked) {
 		if(ShouldClose()) {
@@ -352,33 +987,40 @@ void pragma::platform::Window::UpdateWindow(const WindowCreationInfo &info)
 	auto yOffset = info.decorated ? 30 : 0;
 	glfwSetWindowMonitor(m_window, monitor, 0, yOffset, info.width, info.height, GLFW_DONT_CARE);
 	glfwSetWindowAttrib(m_window, GLFW_DECORATED, info.decorated ? GLFW_TRUE : GLFW_FALSE);
+	RefreshAttributes();
 }
 
-Vector2i pragma::platform::Window::GetFramebufferSize() const
-{
-	int w = 0;
-	int h = 0;
-	glfwGetFramebufferSize(const_cast<GLFWwindow *>(GetGLFWWindow()), &w, &h);
-	return Vector2i(w, h);
-}
+Vector2i pragma::platform::Window::GetFramebufferSize() const { return m_attributes.framebufferSize; }
 
 Vector4i pragma::platform::Window::GetFrameSize() const
 {
-	int left = 0;
-	int top = 0;
-	int right = 0;
-	int bottom = 0;
-	glfwGetWindowFrameSize(const_cast<GLFWwindow *>(GetGLFWWindow()), &left, &top, &right, &bottom);
-	return Vector4i(left, top, right, bottom);
+	if(!m_attributes.frameSize) {
+		int left = 0;
+		int top = 0;
+		int right = 0;
+		int bottom = 0;
+		glfwGetWindowFrameSize(const_cast<GLFWwindow *>(GetGLFWWindow()), &left, &top, &right, &bottom);
+		m_attributes.frameSize = Vector4i(left, top, right, bottom);
+	}
+	return *m_attributes.frameSize;
 }
 
 void pragma::platform::Window::Iconify() const { glfwIconifyWindow(const_cast<GLFWwindow *>(GetGLFWWindow())); }
 void pragma::platform::Window::Restore() const { glfwRestoreWindow(const_cast<GLFWwindow *>(GetGLFWWindow())); }
-void pragma::platform::Window::Show() const { glfwShowWindow(const_cast<GLFWwindow *>(GetGLFWWindow())); }
-void pragma::platform::Window::Hide() const { glfwHideWindow(const_cast<GLFWwindow *>(GetGLFWWindow())); }
+// There is no visibility callback in GLFW, so the cached state is updated here
+void pragma::platform::Window::Show() const
+{
+	glfwShowWindow(const_cast<GLFWwindow *>(GetGLFWWindow()));
+	m_attributes.visible = true;
+}
+void pragma::platform::Window::Hide() const
+{
+	glfwHideWindow(const_cast<GLFWwindow *>(GetGLFWWindow()));
+	m_attributes.visible = false;
+}
 
 void pragma::platform::Window::Maximize() { glfwMaximizeWindow(const_cast<GLFWwindow *>(GetGLFWWindow())); }
-bool pragma::platform::Window::IsMaximized() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_MAXIMIZED) != GLFW_FALSE) ? true : false; }
+bool pragma::platform::Window::IsMaximized() const { return m_attributes.maximized; }
 std::optional<pragma::platform::MonitorBounds> pragma::platform::Window::GetMonitorBounds() const
 {
 #ifdef _WIN32
@@ -401,42 +1043,134 @@ std::optional<pragma::platform::MonitorBounds> pragma::platform::Window::GetMoni
 #endif
 }
 
-bool pragma::platform::Window::IsFocused() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_FOCUSED) != GLFW_FALSE) ? true : false; }
-bool pragma::platform::Window::IsIconified() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_ICONIFIED) != GLFW_FALSE) ? true : false; }
-bool pragma::platform::Window::IsVisible() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_VISIBLE) != GLFW_FALSE) ? true : false; }
-bool pragma::platform::Window::IsResizable() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_RESIZABLE) != GLFW_FALSE) ? true : false; }
-bool pragma::platform::Window::IsDecorated() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_DECORATED) != GLFW_FALSE) ? true : false; }
-bool pragma::platform::Window::IsFloating() const { return (glfwGetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_FLOATING) != GLFW_FALSE) ? true : false; }
-void pragma::platform::Window::SetResizable(bool resizable) { glfwSetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_RESIZABLE, resizable ? GLFW_TRUE : GLFW_FALSE); }
+bool pragma::platform::Window::IsFocused() const { return m_attributes.focused; }
+bool pragma::platform::Window::IsIconified() const { return m_attributes.iconified; }
+bool pragma::platform::Window::IsVisible() const { return m_attributes.visible; }
+bool pragma::platform::Window::IsResizable() const { return m_attributes.resizable; }
+bool pragma::platform::Window::IsDecorated() const { return m_attributes.decorated; }
+bool pragma::platform::Window::IsFloating() const { return m_attributes.floating; }
+void pragma::platform::Window::SetResizable(bool resizable)
+{
+	glfwSetWindowAttrib(const_cast<GLFWwindow *>(GetGLFWWindow()), GLFW_RESIZABLE, resizable ? GLFW_TRUE : GLFW_FALSE);
+	m_attributes.resizable = resizable;
+}
+void pragma::platform::Window::RefreshAttributes()
+{
+	auto *window = const_cast<GLFWwindow *>(GetGLFWWindow());
+	auto &attrs = m_attributes;
+	glfwGetWindowPos(window, &attrs.pos.x, &attrs.pos.y);
+	glfwGetWindowSize(window, &attrs.size.x, &attrs.size.y);
+	glfwGetFramebufferSize(window, &attrs.framebufferSize.x, &attrs.framebufferSize.y);
+	attrs.frameSize = {};
+	double x = 0.0;
+	double y = 0.0;
+	glfwGetCursorPos(window, &x, &y);
+	attrs.cursorPos = {static_cast<float>(x), static_cast<float>(y)};
+	auto getAttr = [window](int attr) { return glfwGetWindowAttrib(window, attr) != GLFW_FALSE; };
+	attrs.focused = getAttr(GLFW_FOCUSED);
+	attrs.iconified = getAttr(GLFW_ICONIFIED);
+	attrs.maximized = getAttr(GLFW_MAXIMIZED);
+	attrs.visible = getAttr(GLFW_VISIBLE);
+	attrs.resizable = getAttr(GLFW_RESIZABLE);
+	attrs.decorated = getAttr(GLFW_DECORATED);
+	attrs.floating = getAttr(GLFW_FLOATING);
+}
 
 void pragma::platform::Window::SetCursor(const Cursor &cursor)
 {
+	m_animatedCursor = nullptr;
 	auto *c = cursor.GetGLFWCursor();
 	glfwSetCursor(const_cast<GLFWwindow *>(GetGLFWWindow()), const_cast<GLFWcursor *>(c));
 }
 void pragma::platform::Window::SetCursor(Cursor::Shape shape) { SetCursor(Cursor::GetStandardCursor(shape)); }
-void pragma::platform::Window::ClearCursor() { glfwSetCursor(const_cast<GLFWwindow *>(GetGLFWWindow()), nullptr); }
+void pragma::platform::Window::SetCursor(const std::shared_ptr<AnimatedCursor> &cursor)
+{
+	if(!cursor) {
+		ClearCursor();
+		return;
+	}
+	m_animatedCursor = cursor;
+	m_cursorAnimationStartTime = get_time();
+	m_cursorAnimationFrame = 0;
+	auto *c = cursor->GetFrames().front().cursor->GetGLFWCursor();
+	glfwSetCursor(const_cast<GLFWwindow *>(GetGLFWWindow()), const_cast<GLFWcursor *>(c));
+	RequestPoll();
+}
+void pragma::platform::Window::UpdateCursorAnimation()
+{
+	// All frames have already been created, switching frames only swaps the GLFW cursor
+	auto frameIndex = m_animatedCursor->GetFrameIndex(get_time() - m_cursorAnimationStartTime);
+	if(frameIndex != m_cursorAnimationFrame) {
+		m_cursorAnimationFrame = frameIndex;
+		auto *c = m_animatedCursor->GetFrames()[frameIndex].cursor->GetGLFWCursor();
+		glfwSetCursor(const_cast<GLFWwindow *>(GetGLFWWindow()), const_cast<GLFWcursor *>(c));
+	}
+	RequestPoll();
+}
+void pragma::platform::Window::ClearCursor()
+{
+	m_animatedCursor = nullptr;
+	glfwSetCursor(const_cast<GLFWwindow *>(GetGLFWWindow()), nullptr);
+}
 
 #ifdef _WIN32
 HWND pragma::platform::Window::GetWin32Handle() const { return glfwGetWin32Window(const_cast<GLFWwindow *>(GetGLFWWindow())); }
 HGLRC pragma::platform::Window::GetOpenGLContextHandle() const { return glfwGetWGLContext(const_cast<GLFWwindow *>(GetGLFWWindow())); }
 #endif
 
+// All windows, in no particular order. Every window knows its own index, so it can be removed in constant time.
 static std::vector<pragma::platform::Window *> g_windows;
+// Windows that have to be polled during the next poll_events() call, and the windows that are currently being polled
+static std::vector<pragma::platform::Window *> g_pendingPollWindows;
+static std::vector<pragma::platform::Window *> g_pollingWindows;
 std::vector<pragma::platform::Window *> &pragma::platform::Window::GetWindows() { return g_windows; }
 
+void pragma::platform::Window::RequestPoll()
+{
+	if(m_pollRequested)
+		return;
+	m_pollRequested = true;
+	g_pendingPollWindows.push_back(this);
+}
+
+void pragma::platform::Window::PollWindows()
+{
+	g_pollingWindows.swap(g_pendingPollWindows);
+	for(size_t i = 0; i < g_pollingWindows.size(); ++i) {
+		// May be nullptr if the window was destroyed by a callback of a previous window
+		auto *window = g_pollingWindows[i];
+		if(!window)
+			continue;
+		window->m_pollRequested = false;
+		window->Poll();
+	}
+	g_pollingWindows.clear();
+}
+
 pragma::platform::Window::~Window()
 {
 #ifdef _WIN32
 	ReleaseFileDropHandler();
+#endif
+#ifdef __linux__
+	if(m_pendingWaylandDragAndDrop)
+		cancel_timer(m_pendingWaylandDragAndDrop->timer);
 #endif
 	m_handle.Invalidate();
 	glfwDestroyWindow(m_window);
 
-	auto it = std::find(g_windows.begin(), g_windows.end(), this);
-	assert(it != g_windows.end());
-	if(it != g_windows.end())
-		g_windows.erase(it);
+	assert(m_registryIndex < g_windows.size() && g_windows[m_registryIndex] == this);
+	if(m_registryIndex < g_windows.size() && g_windows[m_registryIndex] == this) {
+		g_windows[m_registryIndex] = g_windows.back();
+		g_windows[m_registryIndex]->m_registryIndex = m_registryIndex;
+		g_windows.pop_back();
+	}
+	// Only windows with pending work are in these lists, so this is cheap
+	for(auto *list : {&g_pendingPollWindows, &g_pollingWindows}) {
+		auto it = std::find(list->begin(), list->end(), this);
+		if(it != list->end())
+			*it = nullptr;
+	}
 }
 
 void pragma::platform::Window::Reinitialize(const WindowCreationInfo &info)
@@ -467,6 +1201,249 @@ void pragma::platform::Window::Reinitialize(const WindowCreationInfo &info)
 	m_creationInfo.title = info.title;
 	m_creationInfo.monitor = info.monitor;
 	m_creationInfo.refreshRate = info.refreshRate;
+	RefreshAttributes();
+}
+
+void pragma::platform::Window::SetCallbackHookInstalled(CallbackHook hook, bool installed)
+{
+	auto *window = m_window;
+	switch(hook) {
+	case CallbackHook::Refresh:
+		if(!installed) {
+			glfwSetWindowRefreshCallback(window, nullptr);
+			break;
+		}
+		glfwSetWindowRefreshCallback(window, [](GLFWwindow *window) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->RefreshCallback();
+		});
+		break;
+	case CallbackHook::Char:
+		if(!installed) {
+			glfwSetCharCallback(window, nullptr);
+			break;
+		}
+		glfwSetCharCallback(window, [](GLFWwindow *window, unsigned int c) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->CharCallback(c);
+		});
+		break;
+	case CallbackHook::CharMods:
+		if(!installed) {
+			glfwSetCharModsCallback(window, nullptr);
+			break;
+		}
+		glfwSetCharModsCallback(window, [](GLFWwindow *window, unsigned int c, int mods) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->CharModsCallback(c, mods);
+		});
+		break;
+	case CallbackHook::CursorEnter:
+		if(!installed) {
+			glfwSetCursorEnterCallback(window, nullptr);
+			break;
+		}
+		glfwSetCursorEnterCallback(window, [](GLFWwindow *window, int entered) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->CursorEnterCallback(entered);
+		});
+		break;
+	case CallbackHook::Scroll:
+		if(!installed) {
+			glfwSetScrollCallback(window, nullptr);
+			break;
+		}
+		glfwSetScrollCallback(window, [](GLFWwindow *window, double x, double y) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->ScrollCallback(x, y);
+		});
+		break;
+	case CallbackHook::Drop:
+		if(!installed) {
+			glfwSetDropCallback(window, nullptr);
+			break;
+		}
+		glfwSetDropCallback(window, [](GLFWwindow *window, int count, const char **paths) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+#ifdef __linux__
+			auto platform = get_platform();
+			if(platform == Platform::Wayland) {
+				// The drag callback is currently not supported for wayland.
+				// As a work-around, we just trigger DragEnterCallback and DragExitCallback
+				// on drop, to make sure the respective code is still executed.
+				// We also introduce a small delay to simulate a
+				// real drag-and-drop interaction.
+				if(!vkWindow->m_pendingWaylandDragAndDrop) {
+					vkWindow->m_pendingWaylandDragAndDrop = std::unique_ptr<WaylandDragAndDropInfo> {new WaylandDragAndDropInfo {}};
+					vkWindow->m_pendingWaylandDragAndDrop->timer = add_timer(std::chrono::milliseconds(100), [vkWindow]() { vkWindow->FinishWaylandDragAndDrop(); });
+					vkWindow->DragEnterCallback();
+				}
+				vkWindow->m_pendingWaylandDragAndDrop->files.Append(count, paths);
+				return;
+			}
+#endif
+			vkWindow->DropCallback(count, paths);
+		});
+		break;
+	case CallbackHook::Preedit:
+		if(!installed) {
+			glfwSetPreeditCallback(window, nullptr);
+			break;
+		}
+		glfwSetPreeditCallback(window, [](GLFWwindow *window, int preedit_count, unsigned int *preedit_string, int block_count, int *block_sizes, int focused_block, int caret) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->PreeditCallback(preedit_count, preedit_string, block_count, block_sizes, focused_block, caret);
+		});
+		break;
+	case CallbackHook::IMEStatus:
+		if(!installed) {
+			glfwSetIMEStatusCallback(window, nullptr);
+			break;
+		}
+		glfwSetIMEStatusCallback(window, [](GLFWwindow *window) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			vkWindow->IMEStatusCallback();
+		});
+		break;
+	case CallbackHook::Drag:
+		// glfwSetDragCallback is currently only implemented for Linux, and only for X11.
+		// Windows drag support is located in file_drop_target.cppm
+		// Wayland is currently not supported (see work-around above).
+		// Once glfwSetDragCallback is officially implemented for all major platforms,
+		// the windows implementation can be removed and the code below can be used.
+		// See https://github.com/glfw/glfw/issues/1898
+#ifdef __linux__
+		if(!installed) {
+			glfwSetDragCallback(window, nullptr);
+			break;
+		}
+		glfwSetDragCallback(window, [](GLFWwindow *window, int entered) {
+			auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
+			if(vkWindow == nullptr)
+				return;
+			if(entered == 1)
+				vkWindow->DragEnterCallback();
+			else
+				vkWindow->DragExitCallback();
+		});
+#endif
+		break;
+	default:
+		break;
+	}
+	static_assert(math::to_integral(CallbackHook::Count) == 9, "Update this list when new callback hooks are added!");
+	m_installedHooks.set(math::to_integral(hook), installed);
+}
+
+bool pragma::platform::Window::IsCallbackHookRequired(CallbackHook hook) const
+{
+	// Events that are recorded, queued or forwarded to a channel have to be captured regardless of the callbacks
+	if(m_eventQueue || m_inputChannel || m_inputRecorder) {
+		if(hook != CallbackHook::Refresh && hook != CallbackHook::Preedit && hook != CallbackHook::IMEStatus)
+			return true;
+	}
+	auto &callbacks = m_callbackInterface;
+	switch(hook) {
+	case CallbackHook::Refresh:
+		return callbacks.refreshCallback != nullptr || HasListeners(WindowEvent::Refresh);
+	case CallbackHook::Char:
+		if(m_textInputBatch && (callbacks.textInputCallback != nullptr || HasListeners(WindowEvent::TextInput)))
+			return true;
+		return callbacks.charCallback != nullptr || HasListeners(WindowEvent::Char);
+	case CallbackHook::CharMods:
+		return callbacks.charModsCallback != nullptr || HasListeners(WindowEvent::CharMods);
+	case CallbackHook::CursorEnter:
+		return callbacks.cursorEnterCallback != nullptr || HasListeners(WindowEvent::CursorEnter);
+	case CallbackHook::Scroll:
+		return callbacks.scrollCallback != nullptr || HasListeners(WindowEvent::Scroll);
+	case CallbackHook::Drop:
+		if(callbacks.dropCallback != nullptr || callbacks.dropPathsCallback != nullptr || m_dropPrefetchCallback != nullptr || HasListeners(WindowEvent::Drop))
+			return true;
+#ifdef __linux__
+		// Drag events are emulated through the drop callback on Wayland
+		if(get_platform() == Platform::Wayland)
+			return IsCallbackHookRequired(CallbackHook::Drag);
+#endif
+		return false;
+	case CallbackHook::Drag:
+		return callbacks.dragEnterCallback != nullptr || callbacks.dragExitCallback != nullptr || HasListeners(WindowEvent::DragEnter) || HasListeners(WindowEvent::DragExit);
+	case CallbackHook::Preedit:
+		return callbacks.preeditCallback != nullptr || callbacks.preeditTextCallback != nullptr || HasListeners(WindowEvent::Preedit) || HasListeners(WindowEvent::PreeditText);
+	case CallbackHook::IMEStatus:
+		return callbacks.imeStatusCallback != nullptr || HasListeners(WindowEvent::IMEStatus);
+	default:
+		break;
+	}
+	static_assert(math::to_integral(CallbackHook::Count) == 9, "Update this list when new callback hooks are added!");
+	return false;
+}
+
+void pragma::platform::Window::UpdateCallbackHooks()
+{
+	for(auto i = decltype(m_installedHooks.size()) {0}; i < m_installedHooks.size(); ++i) {
+		auto hook = static_cast<CallbackHook>(i);
+		auto required = IsCallbackHookRequired(hook);
+		if(required != m_installedHooks.test(i))
+			SetCallbackHookInstalled(hook, required);
+	}
+}
+
+namespace {
+	template<typename TFunc, size_t... I>
+	auto visit_listener_list(pragma::platform::WindowListenerLists &lists, size_t index, const TFunc &func, std::index_sequence<I...>)
+	{
+		std::invoke_result_t<TFunc, std::tuple_element_t<0, pragma::platform::WindowListenerLists> &> result {};
+		((I == index ? (result = func(std::get<I>(lists)), true) : false) || ...);
+		return result;
+	}
+	template<typename TFunc>
+	auto visit_listener_list(pragma::platform::WindowListenerLists &lists, size_t index, const TFunc &func)
+	{
+		return visit_listener_list(lists, index, func, std::make_index_sequence<std::tuple_size_v<pragma::platform::WindowListenerLists>> {});
+	}
+};
+
+bool pragma::platform::Window::RemoveListener(ListenerToken token)
+{
+	if(!m_listeners || !token.IsValid())
+		return false;
+	auto removed = visit_listener_list(*m_listeners, token.list, [&token](auto &list) { return list.Remove(token.id); });
+	if(removed)
+		UpdateCallbackHooks();
+	return removed;
+}
+bool pragma::platform::Window::HasListeners(WindowEvent event) const
+{
+	if(!m_listeners)
+		return false;
+	return visit_listener_list(*m_listeners, math::to_integral(event), [](auto &list) { return !list.IsEmpty(); });
+}
+void pragma::platform::Window::ClearListeners()
+{
+	if(!m_listeners)
+		return;
+	for(size_t i = 0; i < std::tuple_size_v<WindowListenerLists>; ++i)
+		visit_listener_list(*m_listeners, i, [](auto &list) {
+			list.Clear();
+			return true;
+		});
+	UpdateCallbackHooks();
 }
 
 std::expected<std::unique_ptr<pragma::platform::Window>, std::string> pragma::platform::Window::Create(const WindowCreationInfo &info)
@@ -532,16 +1509,11 @@ std::expected<std::unique_ptr<pragma::platform::Window>, std::string> pragma::pl
 		return std::unexpected {errMsgStream.str()};
 	}
 	auto vkWindow = std::unique_ptr<Window>(new Window(window));
-	glfwSetWindowRefreshCallback(window, [](GLFWwindow *window) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		vkWindow->RefreshCallback();
-	});
 	glfwSetFramebufferSizeCallback(window, [](GLFWwindow *window, int width, int height) {
 		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
 		if(vkWindow == nullptr)
 			return;
+		vkWindow->FramebufferSizeCallback(width, height);
 		vkWindow->RefreshCallback();
 	});
 	glfwSetKeyCallback(window, [](GLFWwindow *window, int key, int scancode, int action, int mods) {
@@ -550,88 +1522,25 @@ std::expected<std::unique_ptr<pragma::platform::Window>, std::string> pragma::pl
 			return;
 		vkWindow->KeyCallback(key, scancode, action, mods);
 	});
-	glfwSetCharCallback(window, [](GLFWwindow *window, unsigned int c) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		vkWindow->CharCallback(c);
-	});
-	glfwSetCharModsCallback(window, [](GLFWwindow *window, unsigned int c, int mods) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		vkWindow->CharModsCallback(c, mods);
-	});
-	glfwSetCursorEnterCallback(window, [](GLFWwindow *window, int entered) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		vkWindow->CursorEnterCallback(entered);
-	});
 	glfwSetCursorPosCallback(window, [](GLFWwindow *window, double x, double y) {
 		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
 		if(vkWindow == nullptr)
 			return;
 		vkWindow->CursorPosCallback(x, y);
 	});
-	glfwSetDropCallback(window, [](GLFWwindow *window, int count, const char **paths) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-#ifdef __linux__
-		auto platform = get_platform();
-		if(platform == Platform::Wayland) {
-			// The drag callback is currently not supported for wayland.
-			// As a work-around, we just trigger DragEnterCallback and DragExitCallback
-			// on drop, to make sure the respective code is still executed.
-			// We also introduce a small delay to simulate a
-			// real drag-and-drop interaction.
-			if(!vkWindow->m_pendingWaylandDragAndDrop) {
-				vkWindow->m_pendingWaylandDragAndDrop = std::unique_ptr<WaylandDragAndDropInfo> {new WaylandDragAndDropInfo {}};
-				vkWindow->m_pendingWaylandDragAndDrop->t = std::chrono::steady_clock::now();
-				vkWindow->DragEnterCallback();
-			}
-			auto &info = *vkWindow->m_pendingWaylandDragAndDrop;
-			info.files.reserve(info.files.size() + count);
-			for(size_t i = 0; i < count; ++i)
-				info.files.push_back(paths[i]);
-			return;
-		}
-#endif
-		vkWindow->DropCallback(count, paths);
-	});
-	// glfwSetDragCallback is currently only implemented for Linux, and only for X11.
-	// Windows drag support is located in file_drop_target.cppm
-	// Wayland is currently not supported (see work-around above).
-	// Once glfwSetDragCallback is officially implemented for all major platforms,
-	// the windows implementation can be removed and the code below can be used.
-	// See https://github.com/glfw/glfw/issues/1898
-#ifdef __linux__
-	glfwSetDragCallback(window, [](GLFWwindow *window, int entered) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		if(entered == 1)
-			vkWindow->DragEnterCallback();
-		else
-			vkWindow->DragExitCallback();
-	});
-#endif
 	glfwSetMouseButtonCallback(window, [](GLFWwindow *window, int button, int action, int mods) {
 		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
 		if(vkWindow == nullptr)
 			return;
 		vkWindow->MouseButtonCallback(button, action, mods);
 	});
-	glfwSetScrollCallback(window, [](GLFWwindow *window, double x, double y) {
+	glfwSetWindowCloseCallback(window, [](GLFWwindow *window) {
 		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
 		if(vkWindow == nullptr)
 			return;
-		vkWindow->ScrollCallback(x, y);
-	});
-	glfwSetWindowCloseCallback(window, [](GLFWwindow *window) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr || vkWindow->m_callbackInterface.closeCallback == nullptr)
+		// The should-close flag is evaluated by Poll()
+		vkWindow->RequestPoll();
+		if(vkWindow->DispatchListeners<WindowEvent::Close>() == ListenerResult::Consume || vkWindow->m_callbackInterface.closeCallback == nullptr)
 			return;
 		vkWindow->m_callbackInterface.closeCallback(*vkWindow);
 	});
@@ -659,21 +1568,18 @@ std::expected<std::unique_ptr<pragma::platform::Window>, std::string> pragma::pl
 			return;
 		vkWindow->WindowSizeCallback(w, h);
 	});
-	glfwSetPreeditCallback(window, [](GLFWwindow *window, int preedit_count, unsigned int *preedit_string, int block_count, int *block_sizes, int focused_block, int caret) {
-		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
-		if(vkWindow == nullptr)
-			return;
-		vkWindow->PreeditCallback(preedit_count, preedit_string, block_count, block_sizes, focused_block, caret);
-	});
-	glfwSetIMEStatusCallback(window, [](GLFWwindow *window) {
+	glfwSetWindowMaximizeCallback(window, [](GLFWwindow *window, int maximized) {
 		auto *vkWindow = static_cast<Window *>(glfwGetWindowUserPointer(window));
 		if(vkWindow == nullptr)
 			return;
-		vkWindow->IMEStatusCallback();
+		vkWindow->MaximizeCallback(maximized);
 	});
 	glfwSetWindowUserPointer(window, vkWindow.get());
+	vkWindow->UpdateCallbackHooks();
 	vkWindow->m_creationInfo = info;
 	vkWindow->m_windowTitle = info.title;
+	vkWindow->RefreshAttributes();
+	vkWindow->m_registryIndex = g_windows.size();
 	g_windows.push_back(vkWindow.get());
 	return vkWindow;
 }
@@ -10,6 +10,7 @@ export module pragma.platform:cursor;
 
 import pragma.math;
 import pragma.util;
+import :image;
 
 export {
 	namespace pragma::platform {
@@ -20,20 +21,73 @@ export {
 
 		class DLLGLFW Cursor {
 		  public:
-			enum class DLLGLFW Shape : uint32_t { Default = 0, Hidden = 1, Arrow = GLFW_ARROW_CURSOR, IBeam = GLFW_IBEAM_CURSOR, Crosshair = GLFW_CROSSHAIR_CURSOR, Hand = GLFW_HAND_CURSOR, HResize = GLFW_HRESIZE_CURSOR, VResize = GLFW_VRESIZE_CURSOR };
+			enum class DLLGLFW Shape : uint32_t {
+				Default = 0,
+				Hidden = 1,
+				Arrow = GLFW_ARROW_CURSOR,
+				IBeam = GLFW_IBEAM_CURSOR,
+				Crosshair = GLFW_CROSSHAIR_CURSOR,
+				Hand = GLFW_HAND_CURSOR,
+				HResize = GLFW_HRESIZE_CURSOR,
+				VResize = GLFW_VRESIZE_CURSOR,
+				ResizeNWSE = GLFW_RESIZE_NWSE_CURSOR,
+				ResizeNESW = GLFW_RESIZE_NESW_CURSOR,
+				ResizeAll = GLFW_RESIZE_ALL_CURSOR,
+				NotAllowed = GLFW_NOT_ALLOWED_CURSOR,
+
+				PointingHand = Hand,
+				ResizeEW = HResize,
+				ResizeNS = VResize,
+			};
+			static constexpr size_t STANDARD_SHAPE_COUNT = 2 + (GLFW_NOT_ALLOWED_CURSOR - GLFW_ARROW_CURSOR + 1);
 		  private:
 			Cursor(GLFWcursor *cursor);
 			GLFWcursor *m_cursor;
 			CursorHandle m_handle;
 		  public:
-			static std::unique_ptr<Cursor> Create(uint32_t width, uint32_t height, unsigned char *data, const Vector2i &hotSpot = Vector2i(0, 0));
+			static std::unique_ptr<Cursor> Create(uint32_t width, uint32_t height, const unsigned char *data, const Vector2i &hotSpot = Vector2i(0, 0));
+			// Returns a shared cursor for the RGBA8 image, which is only created if no cursor with the same pixels and hot spot exists yet.
+			// Returns nullptr if the cursor could not be created. Cursors created this way must not be removed with Remove().
+			static std::shared_ptr<Cursor> GetOrCreate(uint32_t width, uint32_t height, const unsigned char *data, const Vector2i &hotSpot = Vector2i(0, 0));
+			// Converts the image to RGBA8 first, see convert_to_rgba8
+			static std::shared_ptr<Cursor> GetOrCreate(const ImageView &image, const Vector2i &hotSpot = Vector2i(0, 0));
 			static Cursor &GetStandardCursor(Shape shape);
+			// Creates all standard cursors in advance, so GetStandardCursor never has to create a cursor at runtime
+			static void PreloadStandardCursors();
 			~Cursor();
 			CursorHandle GetHandle();
 			void Remove();
 			const GLFWcursor *GetGLFWCursor() const;
 		};
+
+		// A looping sequence of pre-built cursors. The frames are switched by poll_events() while the cursor is set on a window, see Window::SetCursor.
+		class DLLGLFW AnimatedCursor {
+		  public:
+			struct Frame {
+				std::shared_ptr<Cursor> cursor;
+				// In seconds
+				double duration = 0.1;
+			};
+			// Returns nullptr if there are no frames, or if any of the frames has no cursor or a non-positive duration
+			static std::shared_ptr<AnimatedCursor> Create(std::vector<Frame> frames);
+			// Creates a frame for each RGBA8 image through Cursor::GetOrCreate, with the same duration for all frames
+			static std::shared_ptr<AnimatedCursor> Create(uint32_t width, uint32_t height, std::span<const unsigned char *const> frameData, double frameDuration, const Vector2i &hotSpot = Vector2i(0, 0));
+			const std::vector<Frame> &GetFrames() const;
+			double GetDuration() const;
+			// Index of the frame that is displayed t seconds after the animation has started
+			size_t GetFrameIndex(double t) const;
+		  private:
+			AnimatedCursor(std::vector<Frame> &&frames);
+			std::vector<Frame> m_frames;
+			// End time of each frame, relative to the start of the animation
+			std::vector<double> m_frameEndTimes;
+		};
 		using namespace pragma::math::scoped_enum::arithmetic;
 	};
 	REGISTER_ENUM_ARITHMETIC_OPERATORS(pragma::platform::CursorMode)
 }
+
+namespace pragma::platform::detail {
+	// Destroys all cached cursors; Has to be called before GLFW is terminated
+	void clear_cursor_caches();
+};
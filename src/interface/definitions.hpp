@@ -18,4 +18,9 @@
 #endif
 #endif
 
+// SSE2 code paths are used wherever SSE2 is guaranteed to be available. Define IGLFW_DISABLE_SIMD to always use the scalar code paths.
+#if !defined(IGLFW_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IGLFW_SSE2
+#endif
+
 #endif
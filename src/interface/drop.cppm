@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:drop;
+
+export import pragma.math;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Paths of a single drop, stored back to back in one buffer. Every path is followed by a null terminator,
+	// so the data of each view can also be passed on as a C string.
+	class DLLGLFW DropPathList {
+	  public:
+		DropPathList() = default;
+		// The views have to be rebuilt whenever the buffer changes its address
+		DropPathList(const DropPathList &other);
+		DropPathList(DropPathList &&other) noexcept;
+		DropPathList &operator=(const DropPathList &other);
+		DropPathList &operator=(DropPathList &&other) noexcept;
+		void Assign(int count, const char **paths);
+		void Append(int count, const char **paths);
+		void Clear();
+		std::span<const std::string_view> GetPaths() const;
+		size_t GetCount() const;
+		bool IsEmpty() const;
+	  private:
+		void UpdateViews();
+		std::string m_buffer;
+		// Offset of each path in the buffer
+		std::vector<uint32_t> m_offsets;
+		std::vector<std::string_view> m_views;
+	};
+
+	struct DLLGLFW DroppedFile {
+		enum class Type : uint8_t { Missing = 0, File, Directory, Other };
+		std::string_view path;
+		Type type = Type::Missing;
+		// File size in bytes, 0 for anything that isn't a regular file
+		uint64_t size = 0;
+		// The first bytes of the file (up to the prefetch size), e.g. to identify the file format
+		std::span<const uint8_t> prefetchedData;
+	};
+};
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	// Stats, classifies and pre-reads the files of a drop on the shared worker pool
+	class DropPrefetchJob {
+	  public:
+		DropPrefetchJob(DropPathList &&paths, size_t prefetchSize);
+		bool IsComplete() const;
+		// Only valid once the job is complete
+		std::span<const DroppedFile> GetFiles() const;
+		const DropPathList &GetPaths() const;
+		// Processes the next file; Returns false if all files have already been claimed by a worker
+		bool ProcessNext();
+	  private:
+		DropPathList m_paths;
+		size_t m_prefetchSize = 0;
+		std::vector<DroppedFile> m_files;
+		std::vector<std::vector<uint8_t>> m_data;
+		std::atomic<uint32_t> m_nextIndex = 0;
+		std::atomic<uint32_t> m_remaining = 0;
+	};
+
+	// The job is processed asynchronously. Once it is complete, an empty event is posted to wake up wait_events().
+	void submit_drop_prefetch_job(const std::shared_ptr<DropPrefetchJob> &job);
+	// Stops the worker threads after all submitted jobs have been processed. Called by terminate().
+	void shutdown_drop_prefetch_pool();
+};
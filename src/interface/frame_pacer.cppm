@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:frame_pacer;
+
+export import pragma.math;
+import :input_statistics;
+import :timer;
+import :window;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Limits the frame rate of a main loop. WaitForNextFrame() should be called once per frame, followed by poll_events().
+	// While waiting, events are received and processed like in wait_events() and due timers are fired. The last part of the wait
+	// is spent spinning, since the timeout of glfwWaitEventsTimeout is not precise enough to hit the deadline on its own.
+	class DLLGLFW FramePacer {
+	  public:
+		// A frame rate of 0 means that no frames are produced at all, i.e. WaitForNextFrame() blocks until the state changes.
+		// If no frame rate is set, the refresh rate of the monitor the window is located on is used.
+		struct DLLGLFW Policy {
+			std::optional<float> focusedFrameRate {};
+			std::optional<float> unfocusedFrameRate = 30.f;
+			std::optional<float> iconifiedFrameRate = 0.f;
+		};
+		struct DLLGLFW Statistics {
+			// Time between the ends of two consecutive WaitForNextFrame() calls
+			LatencyHistogram::Snapshot frameTime;
+			// Absolute deviation of the frame time from the target frame time
+			LatencyHistogram::Snapshot jitter;
+			// Frames whose deadline had already passed when WaitForNextFrame() was called
+			uint64_t missedFrames = 0;
+		};
+
+		FramePacer(Window *window = nullptr);
+		void SetWindow(Window *window);
+		Window *GetWindow() const;
+		void SetPolicy(const Policy &policy);
+		const Policy &GetPolicy() const;
+		// Upper limit for all frame rates of the policy, including the monitor refresh rate
+		void SetFrameRateCap(std::optional<float> cap);
+		std::optional<float> GetFrameRateCap() const;
+		// How long before the deadline to stop waiting for events and start spinning instead
+		void SetSpinDuration(TimerClock::duration duration);
+		TimerClock::duration GetSpinDuration() const;
+		// The frame rate that applies to the current window state, or std::nullopt if it is unlimited
+		std::optional<float> GetTargetFrameRate();
+
+		void WaitForNextFrame();
+		// Ends the current WaitForNextFrame() call early. Can be called from any thread.
+		void Interrupt();
+
+		Statistics GetStatistics() const;
+		void ResetStatistics();
+	  private:
+		std::optional<float> GetRefreshRate();
+		// Returns false if the wait was interrupted
+		bool WaitUntil(TimerClock::time_point t);
+		void RecordFrame(TimerClock::time_point t, std::optional<TimerClock::duration> targetFrameTime);
+
+		WindowHandle m_window {};
+		Policy m_policy {};
+		std::optional<float> m_frameRateCap {};
+		TimerClock::duration m_spinDuration = std::chrono::milliseconds(2);
+		std::atomic<bool> m_interrupted = false;
+
+		// Scheduled start of the last frame
+		std::optional<TimerClock::time_point> m_frameDeadline {};
+		std::optional<TimerClock::time_point> m_lastFrame {};
+		LatencyHistogram m_frameTimes;
+		LatencyHistogram m_jitter;
+		uint64_t m_missedFrames = 0;
+
+		// The refresh rate is only re-queried if the window has been moved, or once per second
+		std::optional<float> m_refreshRate {};
+		Vector2i m_refreshRateWindowPos {};
+		TimerClock::time_point m_refreshRateQueryTime {};
+	};
+};
+#pragma warning(pop)
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:gamepad;
+
+import :keys;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	enum class GamepadAxis : uint8_t {
+		LeftX = GLFW_GAMEPAD_AXIS_LEFT_X,
+		LeftY = GLFW_GAMEPAD_AXIS_LEFT_Y,
+		RightX = GLFW_GAMEPAD_AXIS_RIGHT_X,
+		RightY = GLFW_GAMEPAD_AXIS_RIGHT_Y,
+		LeftTrigger = GLFW_GAMEPAD_AXIS_LEFT_TRIGGER,
+		RightTrigger = GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER,
+
+		Count
+	};
+	enum class GamepadButton : uint8_t {
+		A = GLFW_GAMEPAD_BUTTON_A,
+		B = GLFW_GAMEPAD_BUTTON_B,
+		X = GLFW_GAMEPAD_BUTTON_X,
+		Y = GLFW_GAMEPAD_BUTTON_Y,
+		LeftBumper = GLFW_GAMEPAD_BUTTON_LEFT_BUMPER,
+		RightBumper = GLFW_GAMEPAD_BUTTON_RIGHT_BUMPER,
+		Back = GLFW_GAMEPAD_BUTTON_BACK,
+		Start = GLFW_GAMEPAD_BUTTON_START,
+		Guide = GLFW_GAMEPAD_BUTTON_GUIDE,
+		LeftThumb = GLFW_GAMEPAD_BUTTON_LEFT_THUMB,
+		RightThumb = GLFW_GAMEPAD_BUTTON_RIGHT_THUMB,
+		DpadUp = GLFW_GAMEPAD_BUTTON_DPAD_UP,
+		DpadRight = GLFW_GAMEPAD_BUTTON_DPAD_RIGHT,
+		DpadDown = GLFW_GAMEPAD_BUTTON_DPAD_DOWN,
+		DpadLeft = GLFW_GAMEPAD_BUTTON_DPAD_LEFT,
+		// Synthesized from the trigger axes, see GamepadConfig::triggerThreshold
+		LeftTrigger,
+		RightTrigger,
+
+		Count
+	};
+	enum class GamepadStick : uint8_t { Left = 0, Right, Count };
+
+	struct DLLGLFW GamepadConfig {
+		enum class DeadzoneMode : uint8_t {
+			None = 0,
+			// Each axis is clamped and rescaled individually (square deadzone)
+			Axial,
+			// The stick is clamped by its distance from the center
+			Radial,
+			// Like Radial, but the remaining range is rescaled to [0,1] so there is no jump at the deadzone edge
+			ScaledRadial
+		};
+		enum class ResponseCurve : uint8_t {
+			Linear = 0,
+			// |v|^exponent
+			Exponential,
+			// Piecewise-linear lookup table over the magnitude range [0,1]
+			Custom
+		};
+		struct Stick {
+			DeadzoneMode deadzoneMode = DeadzoneMode::ScaledRadial;
+			float innerDeadzone = 0.15f;
+			// Magnitudes above this value are treated as full deflection
+			float outerDeadzone = 0.95f;
+		};
+		struct Axis {
+			ResponseCurve curve = ResponseCurve::Linear;
+			float exponent = 2.f;
+			std::vector<float> lut;
+		};
+		std::array<Stick, math::to_integral(GamepadStick::Count)> sticks {};
+		// Applied after the deadzone. The sign of the value is preserved.
+		std::array<Axis, math::to_integral(GamepadAxis::Count)> axes {};
+		// Trigger values are remapped from GLFW's [-1,1] range to [0,1]
+		float triggerDeadzone = 0.05f;
+		// Trigger value at which the LeftTrigger/RightTrigger buttons are pressed
+		float triggerThreshold = 0.5f;
+	};
+
+	struct DLLGLFW GamepadState {
+		static constexpr size_t AXIS_COUNT = math::to_integral(GamepadAxis::Count);
+		static constexpr size_t BUTTON_COUNT = math::to_integral(GamepadButton::Count);
+		std::array<float, AXIS_COUNT> axes {};
+		// Bit i is set if button i is down
+		uint32_t buttons = 0;
+
+		float GetAxis(GamepadAxis axis) const { return axes[math::to_integral(axis)]; }
+		bool IsButtonDown(GamepadButton button) const { return (buttons & (1u << math::to_integral(button))) != 0; }
+	};
+};
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	// Applies the deadzones, response curves and trigger thresholds of the config to a batch of raw GLFW gamepad states.
+	// rawStates and outStates must have the same size.
+	void evaluate_gamepad_states(std::span<const GLFWgamepadstate> rawStates, const GamepadConfig &config, std::span<GamepadState> outStates);
+};
@@ -9,6 +9,9 @@ export module pragma.platform:core;
 
 import :monitor;
 import :joystick;
+import :gamepad;
+import :joystick_backend;
+import :input_recording;
 
 export namespace pragma::platform {
 	enum class Platform : uint8_t {
@@ -32,24 +35,58 @@ export namespace pragma::platform {
 	DLLGLFW std::string get_version_string();
 	DLLGLFW void poll_events();
 	DLLGLFW void poll_joystick_events();
+	// Blocks until an event has been received or the next timer is due (see add_timer). Received events are processed the same way as
+	// by poll_events(), but belong to the same input frame as the events of the next poll_events() call.
 	DLLGLFW void wait_events();
 	DLLGLFW void post_empty_events();
 	DLLGLFW double get_time();
 	DLLGLFW void set_time(double t);
+	// Called immediately for every individual monitor event
 	DLLGLFW void set_monitor_callback(const std::function<void(Monitor, bool)> &callback);
+	// Called at most once per poll_events() call with all monitor changes that have occurred since the last call
+	DLLGLFW void set_monitor_topology_callback(const std::function<void(const MonitorTopologyChange &)> &callback);
 	DLLGLFW void set_joystick_state_callback(const std::function<void(const Joystick &, bool)> &callback);
 	DLLGLFW void set_joystick_button_callback(const std::function<void(const Joystick &, uint32_t, KeyState, KeyState)> &callback);
 	DLLGLFW void set_joystick_axis_callback(const std::function<void(const Joystick &, uint32_t, float, float)> &callback);
+	// See JoystickAxisConfig::generateButtonEvents
+	DLLGLFW void set_joystick_axis_button_callback(const std::function<void(const Joystick &, uint32_t, KeyState, Modifier)> &callback);
+	// Sets the axis processing config of all current and future joysticks. Individual joysticks can be overridden with Joystick::SetAxisConfig.
+	DLLGLFW void set_joystick_axis_config(const std::optional<JoystickAxisConfig> &config);
+	// Appends all joystick button and axis events to the recorder's log
+	DLLGLFW void set_joystick_input_recorder(const std::shared_ptr<InputRecorder> &recorder);
 	DLLGLFW void set_joysticks_enabled(bool b);
+	// Replaces GLFW as the source of joystick states, or restores it if backend is nullptr. Joysticks have to be enabled.
+	// Gamepad states are only available through GLFW.
+	DLLGLFW void set_joystick_backend(std::unique_ptr<JoystickBackend> backend);
+	DLLGLFW JoystickBackend *get_joystick_backend();
+	// Timestamped axis and button changes that were received by the joystick backend during the last poll_joystick_events() call.
+	// Always empty if joysticks are sampled through GLFW.
+	DLLGLFW std::span<const JoystickSample> get_joystick_samples();
 	DLLGLFW void set_joystick_axis_threshold(float threshold);
 	DLLGLFW float get_joystick_axis_threshold();
+	// If enabled, poll_joystick_events() also updates the gamepad state of all joysticks with a gamepad mapping (see Joystick::GetGamepadState)
+	DLLGLFW void set_gamepad_states_enabled(bool enabled);
+	DLLGLFW bool are_gamepad_states_enabled();
+	DLLGLFW void set_gamepad_config(const GamepadConfig &config);
+	DLLGLFW const GamepadConfig &get_gamepad_config();
+	DLLGLFW void set_gamepad_button_callback(const std::function<void(const Joystick &, GamepadButton, KeyState, KeyState)> &callback);
 	DLLGLFW const std::vector<std::shared_ptr<Joystick>> &get_joysticks();
+	// The joystick id is the GLFW joystick id (GLFW_JOYSTICK_1 to GLFW_JOYSTICK_LAST). Returns nullptr if no joystick is connected with that id.
+	DLLGLFW std::shared_ptr<Joystick> get_joystick(uint32_t joystickId);
 	DLLGLFW std::string get_joystick_name(uint32_t joystickId);
 	DLLGLFW const std::vector<float> &get_joystick_axes(uint32_t joystickId);
 	DLLGLFW const std::vector<KeyState> &get_joystick_buttons(uint32_t joystickId);
 	DLLGLFW Monitor get_primary_monitor();
-	DLLGLFW std::vector<Monitor> get_monitors();
+	// The list is cached and only rebuilt after a monitor has been connected or disconnected
+	DLLGLFW const std::vector<Monitor> &get_monitors();
 	DLLGLFW bool is_initialized();
 	DLLGLFW bool is_headless();
 	DLLGLFW void set_swap_interval(int interval);
 };
+
+namespace pragma::platform::detail {
+	// Receives window events and processes everything that depends on them (window polls, timers, monitor topology changes),
+	// without starting a new input frame. Blocks for at most timeout seconds, or until an event has been received if no timeout
+	// is specified, but never past the next timer deadline.
+	void pump_events(std::optional<double> timeout);
+};
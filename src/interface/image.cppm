@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:image;
+
+export import pragma.math;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	enum class PixelFormat : uint8_t {
+		RGBA8 = 0,
+		BGRA8,
+		// Four floats per pixel in the range [0,1]
+		RGBA32F,
+
+		Count
+	};
+
+	// Non-owning view of a source image for icons and cursors
+	struct DLLGLFW ImageView {
+		const void *data = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		PixelFormat format = PixelFormat::RGBA8;
+		// If true, the color channels have been multiplied by alpha
+		bool premultiplied = false;
+		// Size of a row in bytes, or 0 if the rows are tightly packed
+		size_t rowPitch = 0;
+	};
+
+	// Tightly packed RGBA8 image with straight alpha, which is the format expected by GLFW
+	struct DLLGLFW Image {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<unsigned char> pixels;
+	};
+
+	constexpr std::array<uint32_t, 6> DEFAULT_ICON_SIZES {16, 32, 48, 64, 128, 256};
+
+	DLLGLFW Image convert_to_rgba8(const ImageView &image);
+	// Area-averaging (box) filter. Only meant for downscaling; Upscaling repeats the nearest source pixels.
+	DLLGLFW Image downscale_image(const Image &image, uint32_t width, uint32_t height);
+	// Returns one image per size that is not larger than the source image (or only the source image if it is smaller than all sizes)
+	DLLGLFW std::vector<Image> create_icon_set(const ImageView &image, std::span<const uint32_t> sizes = DEFAULT_ICON_SIZES);
+};
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+	// Non-cryptographic hash; Chain calls by passing the previous result as the seed
+	uint64_t hash_image_data(const unsigned char *data, size_t size, uint64_t seed = HASH_SEED);
+	// The following operate on tightly packed 4-byte pixels
+	void swizzle_bgra_to_rgba(const unsigned char *src, unsigned char *dst, size_t pixelCount);
+	void unpremultiply_rgba8(unsigned char *pixels, size_t pixelCount);
+	void convert_rgba32f_to_rgba8(const float *src, unsigned char *dst, size_t pixelCount);
+
+	// Returns the icon set for the image, which is only created if no icon set has been created for the same image contents recently.
+	// The converted pixels of recent images are kept, so that hash collisions can't return the icon set of a different image.
+	std::shared_ptr<const std::vector<Image>> get_icon_set(const ImageView &image);
+	void clear_icon_set_cache();
+};
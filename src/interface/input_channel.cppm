@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_channel;
+
+import :input_event;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#pragma warning(disable : 4324)
+export namespace pragma::platform {
+	// Wait-free single-producer/single-consumer queue of fixed-size input event records.
+	// The producer is the window the channel was created for (i.e. the main thread during poll_events()),
+	// the consumer may be any other (single) thread.
+	// Note: Drop events are not forwarded, since their paths are not part of the event record.
+	class DLLGLFW InputChannel {
+	  public:
+		static constexpr size_t CACHE_LINE_SIZE = 64;
+		InputChannel(uint32_t capacity);
+		InputChannel(const InputChannel &) = delete;
+		InputChannel &operator=(const InputChannel &) = delete;
+
+		// Producer only. Returns false and increments the overflow count if the channel is full.
+		bool Push(const InputEvent &ev);
+
+		// Consumer only
+		bool Pop(InputEvent &outEvent);
+		template<typename TFunc>
+		size_t Drain(TFunc &&func)
+		{
+			auto readIdx = m_readIndex.load(std::memory_order_relaxed);
+			auto writeIdx = m_writeIndex.load(std::memory_order_acquire);
+			auto n = writeIdx - readIdx;
+			for(auto i = readIdx; i != writeIdx; ++i)
+				func(static_cast<const InputEvent &>(m_events[i & m_mask]));
+			m_readIndex.store(writeIdx, std::memory_order_release);
+			return n;
+		}
+
+		size_t GetCapacity() const;
+		// Approximate if called while the other side is active
+		size_t GetSize() const;
+		// Number of events that were discarded because the consumer did not keep up
+		uint64_t GetOverflowCount() const;
+		uint64_t ResetOverflowCount();
+	  private:
+		std::unique_ptr<InputEvent[]> m_events;
+		size_t m_mask = 0;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writeIndex = 0;
+		size_t m_cachedReadIndex = 0; // Producer's copy of m_readIndex
+
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readIndex = 0;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_overflowCount = 0;
+	};
+};
+#pragma warning(pop)
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_event;
+
+import :keys;
+import :drop;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	struct DLLGLFW InputEvent {
+		enum class Type : uint8_t {
+			Key = 0,
+			Char,
+			CharMods,
+			MouseButton,
+			Scroll,
+			CursorPos,
+			CursorEnter,
+			Focus,
+			Iconify,
+			Resize,
+			WindowPos,
+			WindowSize,
+			Drop,
+			DragEnter,
+			DragExit,
+
+			Count
+		};
+		struct KeyData {
+			Key key;
+			int32_t scancode;
+			KeyState state;
+			Modifier mods;
+		};
+		struct CharData {
+			uint32_t codepoint;
+			Modifier mods;
+		};
+		struct MouseButtonData {
+			MouseButton button;
+			KeyState state;
+			Modifier mods;
+		};
+		struct OffsetData {
+			double x;
+			double y;
+		};
+		struct CursorPosData {
+			float x;
+			float y;
+			// Movement since the previous cursor position event
+			float deltaX;
+			float deltaY;
+		};
+		struct ExtentData {
+			int32_t x;
+			int32_t y;
+		};
+		struct StateData {
+			bool value;
+		};
+		struct DropData {
+			// Index into the drop path storage of the queue that recorded the event
+			uint32_t pathIndex;
+			uint32_t pathCount;
+		};
+
+		Type type;
+		// Time at which the event was captured, in the same timebase as get_time()
+		double time;
+		union {
+			KeyData key;
+			CharData character;
+			MouseButtonData mouseButton;
+			OffsetData scroll;
+			CursorPosData cursorPos;
+			StateData cursorEnter;
+			StateData focus;
+			StateData iconify;
+			ExtentData resize;
+			ExtentData windowPos;
+			ExtentData windowSize;
+			DropData drop;
+		};
+	};
+
+	// Growable ring buffer of input events. Events are recorded during poll_events() and consumed by the application
+	// either by walking GetEvents() or by draining the queue.
+	class DLLGLFW InputEventQueue {
+	  public:
+		InputEventQueue(uint32_t initialCapacity = 256);
+		void Push(const InputEvent &ev);
+		void PushDrop(int count, const char **paths, double time);
+		bool Pop(InputEvent &outEvent);
+		void Clear();
+		size_t GetSize() const;
+		bool IsEmpty() const;
+		// If the recorded events wrap around the end of the ring buffer, the second span will be non-empty
+		std::array<std::span<const InputEvent>, 2> GetEvents() const;
+		// Rearranges the ring buffer if necessary, so that all events can be returned as a single span
+		std::span<const InputEvent> GetContiguousEvents();
+		std::span<const std::string_view> GetDropPaths(const InputEvent &ev) const;
+		// Paths may be moved out of the queue, e.g. if new events can be pushed while they are still in use
+		DropPathList &GetDropPathList(const InputEvent &ev);
+		// The paths of popped drop events stay valid until this is called (or the queue is cleared).
+		// Has no effect while events are still queued.
+		void ReleaseDropPaths();
+
+		template<typename TFunc>
+		void Drain(TFunc &&func)
+		{
+			InputEvent ev;
+			while(Pop(ev))
+				func(ev);
+			ReleaseDropPaths();
+		}
+	  private:
+		void Grow();
+		std::vector<InputEvent> m_events;
+		size_t m_head = 0;
+		size_t m_size = 0;
+		std::vector<DropPathList> m_dropPaths;
+	};
+
+	// Returns the index of the fixed-timestep tick the specified time falls into
+	DLLGLFW int64_t get_input_tick_index(double time, double firstTickTime, double tickInterval);
+
+	// Splits events (ordered by capture time) into fixed-timestep simulation ticks. The function is called once for each of the
+	// tickCount ticks starting at firstTickTime, with the events that were captured during that tick. Events captured before the
+	// first tick are assigned to the first tick, events captured after the last tick are assigned to the last tick.
+	template<typename TFunc>
+	void for_each_input_tick(std::span<const InputEvent> events, double firstTickTime, double tickInterval, uint32_t tickCount, TFunc &&func)
+	{
+		auto it = events.begin();
+		for(uint32_t tick = 0; tick < tickCount; ++tick) {
+			auto itStart = it;
+			if(tick == tickCount - 1)
+				it = events.end();
+			else {
+				auto tickEnd = firstTickTime + (tick + 1) * tickInterval;
+				while(it != events.end() && it->time < tickEnd)
+					++it;
+			}
+			func(tick, std::span<const InputEvent> {itStart, it});
+		}
+	}
+};
+#pragma warning(pop)
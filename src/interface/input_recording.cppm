@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_recording;
+
+import :input_event;
+import :keys;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// The input log consists of a FileHeader, followed by a sequence of records. Each record consists of a RecordHeader
+	// and a payload of RecordHeader::size bytes. All values are stored in native byte order, so logs can only be
+	// replayed on platforms with the same endianness and InputEvent layout.
+	namespace input_log {
+		constexpr std::array<char, 4> MAGIC {'P', 'I', 'L', 'G'};
+		constexpr uint32_t VERSION = 1;
+		enum class RecordType : uint32_t {
+			Event = 0,      // Payload: InputEvent
+			Drop,           // Payload: uint32_t path count, followed by a uint32_t length and the characters of each path
+			JoystickButton, // Payload: JoystickButtonRecord
+			JoystickAxis,   // Payload: JoystickAxisRecord
+		};
+		struct FileHeader {
+			std::array<char, 4> magic;
+			uint32_t version;
+			uint32_t eventSize;
+			uint32_t reserved;
+			double startTime;
+		};
+		struct RecordHeader {
+			RecordType type;
+			uint32_t size;
+			double time;
+		};
+		struct JoystickButtonRecord {
+			int32_t joystickId;
+			uint32_t button;
+			KeyState oldState;
+			KeyState newState;
+		};
+		struct JoystickAxisRecord {
+			int32_t joystickId;
+			uint32_t axis;
+			float oldValue;
+			float newValue;
+		};
+	};
+
+	// Appends input events to a binary log, which can be replayed with InputReplay
+	class DLLGLFW InputRecorder {
+	  public:
+		static std::expected<std::shared_ptr<InputRecorder>, std::string> Create(const std::string &fileName);
+		InputRecorder(const InputRecorder &) = delete;
+		InputRecorder &operator=(const InputRecorder &) = delete;
+		~InputRecorder();
+		void RecordEvent(const InputEvent &ev);
+		void RecordDrop(int count, const char **paths, double time);
+		void RecordJoystickButton(int32_t joystickId, uint32_t button, KeyState oldState, KeyState newState, double time);
+		void RecordJoystickAxis(int32_t joystickId, uint32_t axis, float oldValue, float newValue, double time);
+		void Flush();
+		uint64_t GetRecordCount() const;
+	  private:
+		InputRecorder() = default;
+		void WriteRecord(input_log::RecordType type, double time, const void *data, uint32_t size);
+		std::ofstream m_file;
+		std::vector<char> m_scratch;
+		uint64_t m_recordCount = 0;
+	};
+};
+#pragma warning(pop)
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_replay;
+
+import :input_recording;
+import :joystick;
+import :window;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Replays an input log written by InputRecorder through the regular window and joystick dispatch.
+	// The log is memory-mapped and records are decoded one at a time while replaying.
+	class DLLGLFW InputReplay {
+	  public:
+		static std::expected<std::unique_ptr<InputReplay>, std::string> Open(const std::string &fileName);
+		InputReplay(const InputReplay &) = delete;
+		InputReplay &operator=(const InputReplay &) = delete;
+		~InputReplay();
+
+		// Window events are dispatched to this window; they are skipped if there is none.
+		// The window has to stay valid until it is replaced or the replay is destroyed.
+		void SetTargetWindow(Window *window);
+		// Recorded timestamps are remapped to timeBase + (t - start time of the recording).
+		// Defaults to the result of get_time() at the time the log was opened.
+		void SetTimeBase(double timeBase);
+		// Replays all records that were captured up to the specified time, relative to the start of the recording.
+		// Returns false once the end of the log has been reached.
+		bool Advance(double time);
+		void ReplayAll();
+		bool IsComplete() const;
+		uint64_t GetReplayedRecordCount() const;
+	  private:
+		InputReplay() = default;
+		void ReplayRecord(const input_log::RecordHeader &header, const uint8_t *payload);
+		Joystick *GetJoystick(int32_t joystickId);
+
+		const uint8_t *m_data = nullptr;
+		size_t m_size = 0;
+		size_t m_offset = 0;
+#ifdef _WIN32
+		void *m_fileHandle = nullptr;
+		void *m_mappingHandle = nullptr;
+#endif
+		double m_startTime = 0.0;
+		double m_timeBase = 0.0;
+		uint64_t m_replayedRecordCount = 0;
+		Window *m_targetWindow = nullptr;
+		std::unordered_map<int32_t, std::shared_ptr<Joystick>> m_joysticks;
+		std::vector<std::string> m_dropPaths;
+	};
+};
+#pragma warning(pop)
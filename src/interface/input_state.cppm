@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_state;
+
+import :keys;
+
+export namespace pragma::platform {
+	template<size_t TCount>
+	struct ButtonBitSet {
+		static constexpr size_t BIT_COUNT = TCount;
+		static constexpr size_t WORD_COUNT = (TCount + 63) / 64;
+		std::array<uint64_t, WORD_COUNT> words {};
+
+		bool Test(size_t idx) const { return (words[idx >> 6] >> (idx & 63)) & 1; }
+		void Set(size_t idx) { words[idx >> 6] |= uint64_t {1} << (idx & 63); }
+		void Reset(size_t idx) { words[idx >> 6] &= ~(uint64_t {1} << (idx & 63)); }
+		void Clear() { words = {}; }
+		bool Any() const
+		{
+			for(auto w : words) {
+				if(w != 0)
+					return true;
+			}
+			return false;
+		}
+	};
+
+	// Packed key and mouse button states. "Pressed" and "released" refer to transitions that
+	// occurred during the last frame. A frame ends with every poll_events() call, input received by a preceding wait_events() call
+	// belongs to the same frame.
+	struct DLLGLFW InputState {
+		static constexpr size_t KEY_COUNT = GLFW_KEY_LAST + 1;
+		static constexpr size_t MOUSE_BUTTON_COUNT = GLFW_MOUSE_BUTTON_LAST + 1;
+		struct States {
+			ButtonBitSet<KEY_COUNT> keys;
+			ButtonBitSet<MOUSE_BUTTON_COUNT> mouseButtons;
+		};
+		States current;
+		States previous;
+		States pressed;
+		States released;
+
+		// Starts a new frame
+		void RollOver();
+		void SetKeyState(Key key, KeyState state);
+		void SetMouseButtonState(MouseButton button, KeyState state);
+		// Returns Press if the key was pressed during the last frame, Held if it was already down before and Release otherwise
+		static KeyState GetFrameState(bool down, bool wasDown);
+	};
+};
+
+namespace pragma::platform::detail {
+	// Index of the frame that input is currently being received for. Incremented at the end of every poll_events() call and at
+	// the start of every wait_events() call.
+	uint64_t get_input_frame_index();
+	void advance_input_frame();
+};
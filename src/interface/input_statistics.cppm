@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:input_statistics;
+
+import :input_event;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Lock-free histogram of durations in nanoseconds. Buckets are logarithmic, with four sub-buckets per power of two,
+	// which keeps the relative error of percentile estimates below 25%.
+	class DLLGLFW LatencyHistogram {
+	  public:
+		static constexpr uint32_t SUB_BUCKET_COUNT = 4;
+		static constexpr uint32_t BUCKET_COUNT = 192;
+		static uint32_t GetBucketIndex(uint64_t ns);
+		// Smallest value that falls into the specified bucket
+		static uint64_t GetBucketLowerBound(uint32_t bucketIndex);
+
+		struct DLLGLFW Snapshot {
+			std::array<uint64_t, BUCKET_COUNT> buckets {};
+			uint64_t count = 0;
+			uint64_t totalNs = 0;
+			uint64_t maxNs = 0;
+			// Estimate of the specified percentile (in the range [0,1]) in nanoseconds
+			uint64_t GetPercentile(double percentile) const;
+			double GetMean() const;
+		};
+
+		void Record(uint64_t ns);
+		Snapshot GetSnapshot() const;
+		void Reset();
+	  private:
+		std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets {};
+		std::atomic<uint64_t> m_totalNs = 0;
+		std::atomic<uint64_t> m_maxNs = 0;
+	};
+
+	struct DLLGLFW InputStatistics {
+		static constexpr auto EVENT_TYPE_COUNT = static_cast<size_t>(InputEvent::Type::Count);
+		// Duration of the glfwPollEvents call in poll_events()
+		LatencyHistogram::Snapshot pollEvents;
+		// Time between the capture of an event and its dispatch to the callback
+		LatencyHistogram::Snapshot dispatchLatency;
+		// Time spent in the callback, per event type
+		std::array<LatencyHistogram::Snapshot, EVENT_TYPE_COUNT> callbackDurations;
+		// Number of captured events, per event type
+		std::array<uint64_t, EVENT_TYPE_COUNT> eventCounts {};
+	};
+
+	// Instrumentation is disabled by default
+	DLLGLFW void set_input_statistics_enabled(bool enabled);
+	DLLGLFW bool is_input_statistics_enabled();
+	DLLGLFW InputStatistics get_input_statistics();
+	DLLGLFW void reset_input_statistics();
+};
+
+namespace pragma::platform::detail {
+	void record_poll_duration(uint64_t ns);
+	void record_input_event(InputEvent::Type type);
+	void record_input_dispatch(const InputEvent &ev, uint64_t callbackDurationNs);
+};
+#pragma warning(pop)
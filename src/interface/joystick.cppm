@@ -8,34 +8,136 @@ module;
 export module pragma.platform:joystick;
 
 import :keys;
+import :gamepad;
 
 #pragma warning(push)
 #pragma warning(disable : 4251)
 export namespace pragma::platform {
+	struct DLLGLFW JoystickAxisConfig {
+		enum class Filter : uint8_t {
+			None = 0,
+			// value = lerp(value, input, 1 - smoothing)
+			Exponential,
+			// Adaptive low-pass filter that smooths slow movements more than fast ones (Casiez et al., "1 Euro Filter")
+			OneEuro
+		};
+		Filter filter = Filter::None;
+		// Exponential filter only, in [0,1). Higher values result in smoother but more delayed output.
+		float smoothing = 0.5f;
+		// One-Euro filter only
+		float minCutoff = 1.f;
+		float beta = 0.f;
+		float derivativeCutoff = 1.f;
+
+		// The axis callback is only invoked if the value has changed by more than this amount since it was last reported.
+		// Returning to 0 is always reported.
+		float changeEpsilon = 0.f;
+
+		// If enabled, the axis is also reported as a button in either direction. The button is pressed once
+		// the magnitude reaches pressThreshold and released once it drops below releaseThreshold.
+		bool generateButtonEvents = false;
+		float pressThreshold = 0.5f;
+		float releaseThreshold = 0.4f;
+	};
+
 	class DLLGLFW Joystick {
 	  public:
-		static std::shared_ptr<Joystick> Create(int32_t joystickId);
-		std::string GetName() const;
+		static std::shared_ptr<Joystick> Create(int32_t joystickId, uint32_t generation = 0);
+		static std::shared_ptr<Joystick> Create(int32_t joystickId, uint32_t generation, const std::string &name, const std::string &guid);
+		// The name and GUID are queried once when the joystick is created and remain available after it has been disconnected
+		const std::string &GetName() const;
+		const std::string &GetGUID() const;
 		int32_t GetJoystickId() const;
+		// Incremented every time a device is connected to the joystick's slot, which can be used to tell apart
+		// different devices that were assigned the same joystick id
+		uint32_t GetGeneration() const;
 		const std::vector<float> &GetAxes() const;
 		const std::vector<KeyState> &GetButtons() const;
 		void Poll();
+		// Updates the joystick from the specified states instead of querying them from GLFW
+		void Poll(const float *axes, int32_t axisCount, const unsigned char *buttons, int32_t buttonCount);
+		// Time of the last Poll(), in the same timebase as get_time(). All button and axis events are captured at this time.
+		double GetPollTime() const;
+		// Returns true if GLFW has a gamepad mapping for this joystick
+		bool IsGamepad() const;
+		// Only updated by poll_joystick_events() if gamepad states are enabled, see set_gamepad_states_enabled
+		const GamepadState &GetGamepadState() const;
+		void SetGamepadState(const GamepadState &state);
 		void SetButtonCallback(const std::function<void(uint32_t, KeyState, KeyState)> &callback);
 		void SetAxisCallback(const std::function<void(uint32_t, float, float)> &callback);
+		// Invoked for buttons synthesized from axes, see JoystickAxisConfig::generateButtonEvents.
+		// The modifiers contain AxisInput, AxisPress or AxisRelease, and AxisNegative if the axis was deflected in the negative direction.
+		void SetAxisButtonCallback(const std::function<void(uint32_t, KeyState, Modifier)> &callback);
+
+		// Enables the processing stage for all axes. Without an axis config, the axis callback is invoked whenever the value changes.
+		void SetAxisConfig(const JoystickAxisConfig &config);
+		void SetAxisConfig(uint32_t axis, const JoystickAxisConfig &config);
+		void ClearAxisConfigs();
+		const JoystickAxisConfig *GetAxisConfig(uint32_t axis) const;
 	  private:
-		Joystick(int32_t joystickId);
+		Joystick(int32_t joystickId, uint32_t generation, const std::string &name, const std::string &guid);
 		int32_t m_joystickId = -1;
+		uint32_t m_generation = 0;
+		std::string m_name;
+		std::string m_guid;
+		double m_pollTime = 0.0;
 
-		std::vector<KeyState> m_oldButtonStates;
+		// Axis values and raw button bytes are kept as separate contiguous arrays for the current and the previous poll.
+		// Poll() swaps the buffers instead of copying them, and only the entries flagged in the change masks are visited.
 		std::vector<KeyState> m_buttonStates;
+		std::vector<uint8_t> m_oldRawButtonStates;
+		std::vector<uint8_t> m_rawButtonStates;
+		std::vector<uint64_t> m_changedButtons;
 
 		std::vector<float> m_oldAxes;
 		std::vector<float> m_axes;
+		std::vector<uint64_t> m_changedAxes;
+
+		GamepadState m_gamepadState {};
+
+		struct AxisProcessingState {
+			float filtered = 0.f;
+			float derivative = 0.f;
+			float reported = 0.f;
+			// 1 if the synthesized button is pressed in the positive direction, -1 in the negative direction, otherwise 0
+			int8_t buttonDirection = 0;
+			bool initialized = false;
+		};
+		// Empty unless an axis config has been set; otherwise one entry per axis
+		std::optional<JoystickAxisConfig> m_defaultAxisConfig {};
+		std::vector<JoystickAxisConfig> m_axisConfigs;
+		std::vector<AxisProcessingState> m_axisProcessingStates;
+		double m_prevPollTime = 0.0;
+		void ProcessAxes();
+		float FilterAxis(const JoystickAxisConfig &config, AxisProcessingState &state, float value, float dt) const;
+		void UpdateAxisButton(uint32_t axis, const JoystickAxisConfig &config, AxisProcessingState &state, float value);
 
 		std::function<void(uint32_t, KeyState, KeyState)> m_buttonCallback = nullptr;
 		std::function<void(uint32_t, float, float)> m_axisCallback = nullptr;
+		std::function<void(uint32_t, KeyState, Modifier)> m_axisButtonCallback = nullptr;
 		void InitializeButtonStates(int32_t count);
 		void InitializeAxes(int32_t count);
 	};
 };
 #pragma warning(pop)
+
+namespace pragma::platform::detail {
+	constexpr size_t get_change_mask_word_count(size_t count) { return (count + 63) / 64; }
+	// Sets all values with a magnitude below the threshold to 0
+	void apply_axis_deadzone(float *values, size_t count, float threshold);
+	// Sets bit i of the mask if the values at index i differ. The mask has to have room for get_change_mask_word_count(count) words.
+	void compute_change_mask(const float *oldValues, const float *newValues, size_t count, uint64_t *outMask);
+	void compute_change_mask(const uint8_t *oldValues, const uint8_t *newValues, size_t count, uint64_t *outMask);
+
+	template<typename TFunc>
+	void for_each_set_bit(const std::vector<uint64_t> &mask, TFunc &&func)
+	{
+		for(size_t i = 0; i < mask.size(); ++i) {
+			auto word = mask[i];
+			while(word != 0) {
+				func(static_cast<uint32_t>(i * 64 + std::countr_zero(word)));
+				word &= word - 1;
+			}
+		}
+	}
+};
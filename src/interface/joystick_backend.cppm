@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:joystick_backend;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// A single axis or button change reported by a joystick backend
+	struct DLLGLFW JoystickSample {
+		enum class Type : uint8_t { Axis = 0, Button };
+		// Time at which the change was captured by the backend, in the same timebase as get_time()
+		double time = 0.0;
+		int32_t joystickId = -1;
+		uint32_t index = 0;
+		// Axis value in [-1,1], or GLFW_PRESS/GLFW_RELEASE for buttons
+		float value = 0.f;
+		Type type = Type::Axis;
+	};
+
+	struct DLLGLFW JoystickDeviceInfo {
+		std::string name;
+		std::string guid;
+		uint32_t axisCount = 0;
+		uint32_t buttonCount = 0;
+	};
+
+	// Source of joystick states for poll_joystick_events(), see set_joystick_backend.
+	// If no backend is set, joysticks are sampled through GLFW.
+	// Joystick ids of a backend are slot indices in the range [0, SLOT_COUNT).
+	class DLLGLFW JoystickBackend {
+	  public:
+		static constexpr size_t SLOT_COUNT = GLFW_JOYSTICK_LAST + 1;
+		struct Device {
+			JoystickDeviceInfo info;
+			std::vector<float> axes;
+			std::vector<unsigned char> buttons;
+			bool connected = false;
+		};
+
+		virtual ~JoystickBackend() = default;
+		// Called once per poll_joystick_events() on the main thread. Implementations apply all device changes and samples
+		// that have been received since the last call.
+		virtual void Update() = 0;
+		// Number of samples that had to be discarded since the backend was created, e.g. because Update() wasn't called
+		// frequently enough. May be called from any thread.
+		virtual uint64_t GetDroppedSampleCount() const { return 0; }
+		// Returns nullptr if no device is connected in the specified slot
+		const Device *FindDevice(int32_t joystickId) const;
+		// All samples that were applied during the last Update(), in chronological order
+		std::span<const JoystickSample> GetSamples() const;
+	  protected:
+		// The following may only be called from Update()
+		void ClearSamples();
+		void ConnectDevice(int32_t joystickId, const JoystickDeviceInfo &info);
+		void DisconnectDevice(int32_t joystickId);
+		// Updates the device state and records the sample
+		void ApplySample(const JoystickSample &sample);
+	  private:
+		std::array<Device, SLOT_COUNT> m_devices;
+		std::vector<JoystickSample> m_samples;
+	};
+
+	// Backend with manually driven devices, e.g. for automated tests. Changes are applied on the next Update().
+	// Not thread-safe; all calls have to be made on the main thread.
+	class DLLGLFW MockJoystickBackend : public JoystickBackend {
+	  public:
+		virtual void Update() override;
+		void Connect(int32_t joystickId, const JoystickDeviceInfo &info);
+		void Disconnect(int32_t joystickId);
+		// If time is not specified, the result of get_time() is used
+		void SetAxis(int32_t joystickId, uint32_t axis, float value, std::optional<double> time = {});
+		void SetButton(int32_t joystickId, uint32_t button, bool pressed, std::optional<double> time = {});
+	  private:
+		struct PendingChange {
+			enum class Type : uint8_t { Connect = 0, Disconnect, Sample };
+			Type type;
+			int32_t joystickId;
+			JoystickDeviceInfo info;
+			JoystickSample sample;
+		};
+		std::vector<PendingChange> m_pendingChanges;
+	};
+
+	// Reads joysticks and gamepads from /dev/input/event* on a dedicated thread, which timestamps every
+	// axis and button change as it arrives instead of sampling the state once per frame.
+	// Only available on Linux.
+	DLLGLFW std::expected<std::unique_ptr<JoystickBackend>, std::string> create_evdev_joystick_backend();
+};
+#pragma warning(pop)
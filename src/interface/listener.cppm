@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:listener;
+
+export import pragma.math;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Non-owning reference to a callable object, which has to outlive the reference.
+	// Invoking it is a single indirect call, without the type erasure overhead of std::function.
+	template<typename TSignature>
+	class FunctionRef;
+	template<typename TResult, typename... TArgs>
+	class FunctionRef<TResult(TArgs...)> {
+	  public:
+		FunctionRef() = default;
+		template<typename TCallable>
+		    requires(!std::is_same_v<std::remove_cvref_t<TCallable>, FunctionRef> && std::is_invocable_r_v<TResult, TCallable &, TArgs...>)
+		FunctionRef(TCallable &&callable)
+		    : m_object {const_cast<void *>(static_cast<const void *>(std::addressof(callable)))},
+		      m_invoke {[](void *object, TArgs... args) -> TResult { return std::invoke(*static_cast<std::remove_reference_t<TCallable> *>(object), std::forward<TArgs>(args)...); }}
+		{
+		}
+		TResult operator()(TArgs... args) const { return m_invoke(m_object, std::forward<TArgs>(args)...); }
+		explicit operator bool() const { return m_invoke != nullptr; }
+	  private:
+		void *m_object = nullptr;
+		TResult (*m_invoke)(void *, TArgs...) = nullptr;
+	};
+
+	enum class ListenerResult : uint8_t {
+		Continue = 0,
+		// Prevents the event from being passed on to listeners with a lower priority
+		Consume,
+	};
+
+	struct DLLGLFW ListenerToken {
+		uint32_t id = 0;
+		// Identifies the listener list within its owner
+		uint32_t list = 0;
+		bool IsValid() const { return id != 0; }
+	};
+
+	// Ordered list of listeners, the first TInlineCapacity of which are stored without a heap allocation.
+	// Listeners are invoked in order of descending priority, listeners with the same priority in the order they were added.
+	// Listeners may be added and removed while the list is being dispatched; Added listeners are not invoked until the next dispatch.
+	template<uint32_t TInlineCapacity, typename... TArgs>
+	class ListenerList {
+	  public:
+		using Signature = ListenerResult(TArgs...);
+		using Callback = std::function<Signature>;
+
+		// Callbacks that return void never consume the event. Returns the id of the listener, which is never 0.
+		template<typename TCallback>
+		uint32_t Add(TCallback &&callback, int32_t priority = 0)
+		{
+			std::unique_ptr<Callback> owned;
+			if constexpr(std::is_void_v<std::invoke_result_t<TCallback &, TArgs...>>) {
+				owned = std::make_unique<Callback>([callback = std::forward<TCallback>(callback)](TArgs... args) mutable -> ListenerResult {
+					callback(std::forward<TArgs>(args)...);
+					return ListenerResult::Continue;
+				});
+			}
+			else
+				owned = std::make_unique<Callback>(std::forward<TCallback>(callback));
+			Entry entry {};
+			entry.function = *owned;
+			entry.owned = std::move(owned);
+			entry.priority = priority;
+			return Insert(std::move(entry));
+		}
+		// The callable is not copied and has to outlive the listener
+		uint32_t AddRef(FunctionRef<Signature> callback, int32_t priority = 0)
+		{
+			Entry entry {};
+			entry.function = callback;
+			entry.priority = priority;
+			return Insert(std::move(entry));
+		}
+		bool Remove(uint32_t id)
+		{
+			for(uint32_t i = 0; i < m_size; ++i) {
+				auto &entry = Get(i);
+				if(entry.id != id || id == 0)
+					continue;
+				--m_activeCount;
+				if(m_dispatchDepth > 0) {
+					// The entry may currently be executing, so it is only removed once the dispatch has ended
+					entry.id = 0;
+					m_dirty = true;
+					return true;
+				}
+				for(auto j = i; j + 1 < m_size; ++j)
+					std::swap(Get(j), Get(j + 1));
+				PopBack();
+				return true;
+			}
+			return false;
+		}
+		void Clear()
+		{
+			for(uint32_t i = 0; i < m_size; ++i)
+				Get(i).id = 0;
+			m_activeCount = 0;
+			m_dirty = true;
+			if(m_dispatchDepth == 0)
+				Compact();
+		}
+		bool IsEmpty() const { return m_activeCount == 0; }
+		size_t GetCount() const { return m_activeCount; }
+
+		ListenerResult Dispatch(TArgs... args)
+		{
+			if(m_activeCount == 0)
+				return ListenerResult::Continue;
+			++m_dispatchDepth;
+			auto result = ListenerResult::Continue;
+			// Listeners that are added during the dispatch are appended after the current size
+			auto size = m_size;
+			for(uint32_t i = 0; i < size; ++i) {
+				auto &entry = Get(i);
+				if(entry.id == 0)
+					continue;
+				// Copied, since adding a listener may move the entry
+				auto function = entry.function;
+				if(function(args...) == ListenerResult::Consume) {
+					result = ListenerResult::Consume;
+					break;
+				}
+			}
+			if(--m_dispatchDepth == 0 && m_dirty)
+				Compact();
+			return result;
+		}
+	  private:
+		struct Entry {
+			FunctionRef<Signature> function;
+			std::unique_ptr<Callback> owned;
+			uint32_t id = 0;
+			int32_t priority = 0;
+		};
+		Entry &Get(uint32_t i) { return (i < TInlineCapacity) ? m_inline[i] : m_overflow[i - TInlineCapacity]; }
+		void PushBack(Entry &&entry)
+		{
+			if(m_size < TInlineCapacity)
+				m_inline[m_size] = std::move(entry);
+			else
+				m_overflow.push_back(std::move(entry));
+			++m_size;
+		}
+		void PopBack()
+		{
+			--m_size;
+			if(m_size < TInlineCapacity)
+				m_inline[m_size] = {};
+			else
+				m_overflow.pop_back();
+		}
+		// Moves the last entry towards the front until the order is restored
+		void SortBack()
+		{
+			for(auto i = m_size - 1; i > 0; --i) {
+				if(Get(i - 1).priority >= Get(i).priority)
+					break;
+				std::swap(Get(i - 1), Get(i));
+			}
+		}
+		uint32_t Insert(Entry &&entry)
+		{
+			entry.id = m_nextId++;
+			if(m_nextId == 0)
+				m_nextId = 1;
+			auto id = entry.id;
+			PushBack(std::move(entry));
+			++m_activeCount;
+			if(m_dispatchDepth > 0)
+				m_dirty = true;
+			else
+				SortBack();
+			return id;
+		}
+		// Removes all inactive entries and restores the order of the entries that have been added during a dispatch
+		void Compact()
+		{
+			uint32_t numActive = 0;
+			for(uint32_t i = 0; i < m_size; ++i) {
+				if(Get(i).id == 0)
+					continue;
+				if(i != numActive)
+					std::swap(Get(numActive), Get(i));
+				++numActive;
+			}
+			while(m_size > numActive)
+				PopBack();
+			// Insertion sort, which keeps the entries with the same priority in order
+			for(uint32_t i = 1; i < m_size; ++i) {
+				for(auto j = i; j > 0 && Get(j - 1).priority < Get(j).priority; --j)
+					std::swap(Get(j - 1), Get(j));
+			}
+			m_dirty = false;
+		}
+
+		std::array<Entry, TInlineCapacity> m_inline {};
+		std::vector<Entry> m_overflow;
+		uint32_t m_size = 0;
+		uint32_t m_activeCount = 0;
+		uint32_t m_nextId = 1;
+		uint32_t m_dispatchDepth = 0;
+		bool m_dirty = false;
+	};
+};
+#pragma warning(pop)
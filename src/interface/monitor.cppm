@@ -9,23 +9,79 @@ export module pragma.platform:monitor;
 
 export import pragma.math;
 
+namespace pragma::platform::detail {
+	struct MonitorInfo;
+};
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
 export namespace pragma::platform {
+	// Properties that don't change while a monitor is connected (name, physical size and video modes) are cached
+	// and only re-queried after the monitor has been reconnected. The position and the current video mode are always queried from GLFW.
 	class DLLGLFW Monitor {
 	  public:
 		using VideoMode = GLFWvidmode;
 	  private:
 		GLFWmonitor *m_monitor;
+		std::shared_ptr<detail::MonitorInfo> m_info;
 	  public:
 		Monitor(GLFWmonitor *monitor);
 		~Monitor();
 		const GLFWmonitor *GetGLFWMonitor() const;
-		std::string GetName() const;
+		const std::string &GetName() const;
 		Vector2i GetPhysicalSize() const;
 		Vector2i GetPos() const;
 		std::vector<Vector3i> GetGammaRamp() const;
-		void SetGammaRamp(const std::vector<Vector3i> gammaRamp) const;
-		void SetGamma(float gamma) const;
+		void SetGammaRamp(const std::vector<Vector3i> &gammaRamp) const;
+		// Number of entries per channel, or 0 if gamma ramps are not supported (e.g. on Wayland)
+		uint32_t GetGammaRampSize() const;
+		// Each channel must have GetGammaRampSize() entries
+		bool GetGammaRamp(std::span<uint16_t> red, std::span<uint16_t> green, std::span<uint16_t> blue) const;
+		// The last ramp that was applied to or queried from this monitor is cached, and applying the same ramp again is a no-op.
+		// All channels must have GetGammaRampSize() entries. Returns false if the ramp was rejected, in which case the cache is not updated.
+		bool SetGammaRamp(std::span<const uint16_t> red, std::span<const uint16_t> green, std::span<const uint16_t> blue) const;
+		// Applies a ramp generated by generate_gamma_ramp to all channels
+		void SetGamma(float gamma, float brightness = 0.f, float contrast = 1.f) const;
 		VideoMode GetVideoMode() const;
-		std::vector<VideoMode> GetSupportedVideoModes() const;
+		// In the order reported by GLFW (ascending by bit depth, resolution area, width and refresh rate)
+		const std::vector<VideoMode> &GetSupportedVideoModes() const;
+		// Returns the supported video mode that is closest to the specified resolution, then refresh rate, then bit depth (sum of all channels).
+		// If no refresh rate or bit depth is specified, the highest available one is preferred.
+		std::optional<VideoMode> FindVideoMode(const Vector2i &resolution, std::optional<int32_t> refreshRate = {}, std::optional<int32_t> bitDepth = {}) const;
+	};
+
+	// Fills the ramp with the curve ((x^(1/gamma) - 0.5) * contrast + 0.5 + brightness) over x in [0,1], scaled to [0,65535].
+	// With the default brightness and contrast this is the same ramp as the one generated by glfwSetGamma.
+	DLLGLFW void generate_gamma_ramp(std::span<uint16_t> outRamp, float gamma, float brightness = 0.f, float contrast = 1.f);
+
+	// All monitor connections and disconnections that occurred during a poll_events() call, see set_monitor_topology_callback.
+	// A monitor that was connected and disconnected again during the same call is not reported at all.
+	struct DLLGLFW MonitorTopologyChange {
+		std::vector<Monitor> connected;
+		// Only the cached properties of these monitors can be queried, their GLFW handles are no longer valid
+		std::vector<Monitor> disconnected;
 	};
 };
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	struct MonitorInfo {
+		std::string name;
+		Vector2i physicalSize {};
+		std::vector<GLFWvidmode> videoModes;
+		// Indices into videoModes, sorted by width, height, refresh rate and bit depth
+		std::vector<uint32_t> videoModesByResolution;
+		// Size of the hardware ramp, which is independent of the ramps that have been applied
+		std::optional<uint32_t> gammaRampSize {};
+		// Last gamma ramp that was applied to or queried from the monitor, with the red, green and blue channels stored back to back
+		std::vector<uint16_t> gammaRamp;
+	};
+
+	// Called by the GLFW monitor callback; Invalidates the cached monitor list and records the change for the next topology change event.
+	// Returns the monitor, which retains its cached properties after a disconnect.
+	Monitor on_monitor_event(GLFWmonitor *monitor, bool connected);
+	// Returns true if the topology has changed since the last call, in which case outChange contains the coalesced changes
+	bool pop_monitor_topology_change(MonitorTopologyChange &outChange);
+	const std::vector<Monitor> &get_cached_monitors();
+	void clear_monitor_cache();
+};
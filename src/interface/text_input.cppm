@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:text_input;
+
+export import pragma.math;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// UTF-8 version of the preedit callback arguments. All views are only valid for the duration of the callback.
+	struct DLLGLFW PreeditText {
+		std::string_view text;
+		// Conversion blocks as reported by the input method, in order. Each block is a view into text.
+		std::span<const std::string_view> blocks;
+		int32_t focusedBlock = -1;
+		// Byte offset of the caret within text
+		size_t caret = 0;
+	};
+};
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	constexpr uint32_t UTF8_REPLACEMENT_CHARACTER = 0xFFFD;
+	// Appends the UTF-8 encoding of the codepoints to outText. Surrogates and codepoints outside of the Unicode range are replaced with U+FFFD.
+	void encode_utf8(std::span<const uint32_t> codepoints, std::string &outText);
+	// Number of bytes encode_utf8 would produce for the codepoints
+	size_t get_utf8_length(std::span<const uint32_t> codepoints);
+};
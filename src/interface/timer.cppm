@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: (c) 2025 Silverlan <opensource@pragma-engine.com>
+// SPDX-License-Identifier: MIT
+
+module;
+
+#include "includes.hpp"
+
+export module pragma.platform:timer;
+
+export import pragma.math;
+
+#pragma warning(push)
+#pragma warning(disable : 4251)
+export namespace pragma::platform {
+	// Timers are fired from poll_events() on the main thread, and wait_events() only blocks until the next deadline.
+	// They may only be added or cancelled from the main thread (including from within timer callbacks).
+	using TimerId = uint64_t;
+	constexpr TimerId INVALID_TIMER_ID = 0;
+	using TimerClock = std::chrono::steady_clock;
+
+	DLLGLFW TimerId add_timer(TimerClock::duration delay, const std::function<void()> &callback);
+	// If a poll is delayed by more than one interval, missed invocations are skipped instead of being fired back to back
+	DLLGLFW TimerId add_repeating_timer(TimerClock::duration interval, const std::function<void()> &callback);
+	// Returns false if the timer has already been fired (one-shot timers) or cancelled
+	DLLGLFW bool cancel_timer(TimerId id);
+	DLLGLFW bool is_timer_active(TimerId id);
+	DLLGLFW std::optional<TimerClock::time_point> get_next_timer_deadline();
+};
+#pragma warning(pop)
+
+namespace pragma::platform::detail {
+	// Fires all timers that are due. Timers that are added by a callback are fired by the next call at the earliest.
+	void process_timers();
+	void clear_timers();
+};
@@ -15,6 +15,15 @@ export module pragma.platform:window;
 import :monitor;
 import :keys;
 import :cursor;
+import :image;
+import :drop;
+import :listener;
+import :text_input;
+import :timer;
+import :input_event;
+import :input_channel;
+import :input_state;
+import :input_recording;
 
 #pragma warning(push)
 #pragma warning(disable : 4251)
@@ -69,6 +78,43 @@ export namespace pragma::platform {
 		Window *sharedContextWindow = nullptr;
 	};
 
+	enum class WindowEvent : uint8_t {
+		Key = 0,
+		Char,
+		CharMods,
+		MouseButton,
+		Scroll,
+		CursorPos,
+		CursorEnter,
+		Focus,
+		Iconify,
+		Resize,
+		WindowPos,
+		WindowSize,
+		DragEnter,
+		DragExit,
+		Drop,
+		Refresh,
+		Close,
+		Preedit,
+		IMEStatus,
+		TextInput,
+		PreeditText,
+
+		Count
+	};
+	constexpr uint32_t WINDOW_LISTENER_INLINE_CAPACITY = 2;
+	template<typename... TArgs>
+	using WindowListenerList = ListenerList<WINDOW_LISTENER_INLINE_CAPACITY, Window &, TArgs...>;
+	// One listener list per WindowEvent, in the same order
+	using WindowListenerLists = std::tuple<WindowListenerList<Key, int, KeyState, Modifier>, WindowListenerList<unsigned int>, WindowListenerList<unsigned int, Modifier>, WindowListenerList<MouseButton, KeyState, Modifier>, WindowListenerList<Vector2>,
+	  WindowListenerList<Vector2>, WindowListenerList<bool>, WindowListenerList<bool>, WindowListenerList<bool>, WindowListenerList<Vector2i>, WindowListenerList<Vector2i>, WindowListenerList<Vector2i>, WindowListenerList<>, WindowListenerList<>,
+	  WindowListenerList<std::span<const std::string_view>>, WindowListenerList<>, WindowListenerList<>, WindowListenerList<int, unsigned int *, int, int *, int, int>, WindowListenerList<>, WindowListenerList<std::string_view>,
+	  WindowListenerList<const PreeditText &>>;
+	static_assert(std::tuple_size_v<WindowListenerLists> == math::to_integral(WindowEvent::Count), "Update this list when new window events are added!");
+	template<WindowEvent TEvent>
+	using WindowEventListenerList = std::tuple_element_t<math::to_integral(TEvent), WindowListenerLists>;
+
 	struct DLLGLFW CallbackInterface {
 		std::function<void(Window &, Key, int, KeyState, Modifier)> keyCallback = nullptr;
 		std::function<void(Window &)> refreshCallback = nullptr;
@@ -78,6 +124,8 @@ export namespace pragma::platform {
 		std::function<void(Window &, bool)> cursorEnterCallback = nullptr;
 		std::function<void(Window &, Vector2)> cursorPosCallback = nullptr;
 		std::function<void(Window &, std::vector<std::string> &)> dropCallback = nullptr;
+		// Same as dropCallback, but without a copy of every path. The paths are only valid for the duration of the callback.
+		std::function<void(Window &, std::span<const std::string_view>)> dropPathsCallback = nullptr;
 		std::function<void(Window &)> dragEnterCallback = nullptr;
 		std::function<void(Window &)> dragExitCallback = nullptr;
 		std::function<void(Window &, MouseButton, KeyState, Modifier)> mouseButtonCallback = nullptr;
@@ -89,12 +137,18 @@ export namespace pragma::platform {
 		std::function<void(Window &, Vector2i)> windowSizeCallback = nullptr;
 		std::function<void(Window &, int, unsigned int *, int, int *, int, int)> preeditCallback = nullptr;
 		std::function<void(Window &)> imeStatusCallback = nullptr;
+		// Only used if text input batching is enabled, see Window::SetTextInputBatchingEnabled
+		std::function<void(Window &, std::string_view)> textInputCallback = nullptr;
+		std::function<void(Window &, const PreeditText &)> preeditTextCallback = nullptr;
 		std::function<bool(Window &)> onShouldClose = nullptr;
 	};
 
 	class DLLGLFW Window {
 	  public:
+		// The order of the windows may change when a window is destroyed
 		static std::vector<Window *> &GetWindows();
+		// Polls all windows with pending work, e.g. a close request, a pending drop or coalesced input. Called by poll_events().
+		static void PollWindows();
 		static std::expected<std::unique_ptr<Window>, std::string> Create(const WindowCreationInfo &info);
 		~Window();
 		const GLFWwindow *GetGLFWWindow() const;
@@ -110,6 +164,11 @@ export namespace pragma::platform {
 		void SetCursorEnterCallback(const std::function<void(Window &, bool)> &callback);
 		void SetCursorPosCallback(const std::function<void(Window &, Vector2)> &callback);
 		void SetDropCallback(const std::function<void(Window &, std::vector<std::string> &)> &callback);
+		void SetDropPathsCallback(const std::function<void(Window &, std::span<const std::string_view>)> &callback);
+		// If set, the files of every drop are stat'ed and their first prefetchSize bytes are read on worker threads.
+		// The callback is invoked during a later poll_events() call once all files of a drop have been processed, in the order of the drops.
+		// The files are only valid for the duration of the callback. This is independent of the regular drop callbacks.
+		void SetDropPrefetchCallback(const std::function<void(Window &, std::span<const DroppedFile>)> &callback, size_t prefetchSize = 4096);
 		void SetDragEnterCallback(const std::function<void(Window &)> &callback);
 		void SetDragExitCallback(const std::function<void(Window &)> &callback);
 		void SetMouseButtonCallback(const std::function<void(Window &, MouseButton, KeyState, Modifier)> &callback);
@@ -121,10 +180,79 @@ export namespace pragma::platform {
 		void SetWindowSizeCallback(const std::function<void(Window &, Vector2i)> &callback);
 		void SetPreeditCallback(const std::function<void(Window &, int, unsigned int *, int, int *, int, int)> &callback);
 		void SetIMEStatusCallback(const std::function<void(Window &)> &callback);
+		void SetTextInputCallback(const std::function<void(Window &, std::string_view)> &callback);
+		// Same as the preedit callback, but with the preedit string converted to UTF-8
+		void SetPreeditTextCallback(const std::function<void(Window &, const PreeditText &)> &callback);
 		void SetOnShouldCloseCallback(const std::function<bool(Window &)> &callback);
 		void SetCallbacks(const CallbackInterface &callbacks);
+		void SetCallbacks(CallbackInterface &&callbacks);
 		const CallbackInterface &GetCallbacks() const;
 
+		// Unlike the callbacks above, any number of listeners can be added for the same event.
+		// Listeners are invoked in order of descending priority until one of them consumes the event (see ListenerResult).
+		// The callback of the CallbackInterface is invoked after all listeners, unless the event has been consumed.
+		// The callback may also return void, in which case it never consumes the event.
+		template<WindowEvent TEvent, typename TCallback>
+		ListenerToken AddListener(TCallback &&callback, int32_t priority = 0)
+		{
+			auto id = GetListenerList<TEvent>().Add(std::forward<TCallback>(callback), priority);
+			UpdateCallbackHooks();
+			return {id, math::to_integral(TEvent)};
+		}
+		// Same as AddListener, but the callable is not copied into a std::function, and has to outlive the listener
+		template<WindowEvent TEvent>
+		ListenerToken AddListenerRef(FunctionRef<typename WindowEventListenerList<TEvent>::Signature> callback, int32_t priority = 0)
+		{
+			auto id = GetListenerList<TEvent>().AddRef(callback, priority);
+			UpdateCallbackHooks();
+			return {id, math::to_integral(TEvent)};
+		}
+		bool RemoveListener(ListenerToken token);
+		bool HasListeners(WindowEvent event) const;
+		void ClearListeners();
+
+		// If enabled, input events will be recorded into the event queue during poll_events() instead of
+		// being dispatched to the callbacks immediately.
+		void SetEventQueueEnabled(bool enabled);
+		bool IsEventQueueEnabled() const;
+		InputEventQueue *GetEventQueue();
+		// Dispatches all queued events to the callbacks and empties the queue
+		void DispatchQueuedEvents();
+
+		// If enabled, all cursor movements and scroll offsets received during a single poll_events() call are merged
+		// into one cursor position event (final position plus summed delta) and one scroll event.
+		void SetInputCoalescingEnabled(bool enabled);
+		bool IsInputCoalescingEnabled() const;
+		// If enabled, all characters received during a poll_events() call (or a DispatchQueuedEvents() call, if the event queue is enabled)
+		// are encoded as UTF-8 and delivered as a single text input event, instead of one char event per codepoint.
+		// Pending text is delivered before any key, mouse button or preedit event, so its order relative to those events is preserved.
+		// Must not be disabled from within the text input callback.
+		void SetTextInputBatchingEnabled(bool enabled);
+		bool IsTextInputBatchingEnabled() const;
+		// Only applies if input coalescing is enabled
+		void SetCursorHistoryEnabled(bool enabled);
+		bool IsCursorHistoryEnabled() const;
+		// Raw cursor positions received during the last input frame (see InputState)
+		std::span<const Vector2> GetCursorHistory() const;
+		// Movement of the cursor position event that is currently being (or was last) dispatched
+		const Vector2 &GetCursorDelta() const;
+		// Capture time of the event that is currently being (or was last) dispatched, in the same timebase as get_time()
+		double GetEventTime() const;
+
+		// Creates a channel through which all input events of this window are forwarded to a consumer thread,
+		// in addition to the regular dispatch. Replaces the previous channel, if there was one.
+		std::shared_ptr<InputChannel> CreateInputChannel(uint32_t capacity = 1024);
+		const std::shared_ptr<InputChannel> &GetInputChannel() const;
+		void ClearInputChannel();
+
+		// Feeds a synthetic event into the input pipeline as if it had been captured at ev.time.
+		// Drop events are ignored, since their paths can't be passed along; Use InjectDrop instead.
+		void InjectEvent(const InputEvent &ev);
+		void InjectDrop(const std::vector<std::string> &paths, double time);
+		// Appends all input events of this window to the recorder's log
+		void SetInputRecorder(const std::shared_ptr<InputRecorder> &recorder);
+		const std::shared_ptr<InputRecorder> &GetInputRecorder() const;
+
 		void SetBorderColor(const Color &color);
 		std::optional<Color> GetBorderColor() const;
 		void SetTitleBarColor(const Color &color);
@@ -134,7 +262,24 @@ export namespace pragma::platform {
 		void SetShouldClose(bool b);
 		KeyState GetKeyState(Key key);
 		KeyState GetMouseButtonState(MouseButton button);
+		// The following are tracked from the input callbacks. "Pressed" and "released" refer to
+		// transitions that occurred during the last poll_events() call.
+		bool IsKeyDown(Key key) const;
+		bool WasKeyPressed(Key key) const;
+		bool WasKeyReleased(Key key) const;
+		// Returns Press if the key went down during the last poll_events() call, Held if it was already down before and Release otherwise
+		KeyState GetKeyFrameState(Key key) const;
+		bool IsMouseButtonDown(MouseButton button) const;
+		bool WasMouseButtonPressed(MouseButton button) const;
+		bool WasMouseButtonReleased(MouseButton button) const;
+		KeyState GetMouseButtonFrameState(MouseButton button) const;
+		InputState GetInputState() const;
+		// The clipboard contents are cached until one of the windows gains or loses focus, or until SetClipboardString is called.
+		// Only the first call after the cache has been invalidated queries the clipboard, which may block until the clipboard owner responds.
 		std::string GetClipboardString() const;
+		// Same as GetClipboardString, but without a copy. The view remains valid until the clipboard cache is refreshed, i.e. until
+		// the next call to SetClipboardString or to a clipboard getter after the cache has been invalidated.
+		std::string_view GetClipboardStringView() const;
 		void SetClipboardString(const std::string &str);
 		Vector2 GetCursorPos() const;
 		void SetCursorPosOverride(const Vector2 &pos);
@@ -159,6 +304,9 @@ export namespace pragma::platform {
 		const std::string &GetWindowTitle() const;
 		// RGBA32; Recommended size is 48x48
 		void SetWindowIcon(uint32_t width, uint32_t height, const uint8_t *data);
+		// Generates an icon set in all DEFAULT_ICON_SIZES up to the size of the image and passes it to GLFW, which picks the best size for each purpose.
+		// Icon sets are cached by image contents, so setting the same image again does not regenerate them.
+		void SetWindowIcon(const ImageView &image);
 		Vector2i GetPos() const;
 		void SetPos(const Vector2i &pos);
 		Vector2i GetSize() const;
@@ -195,9 +343,14 @@ export namespace pragma::platform {
 		bool IsDecorated() const;
 		bool IsFloating() const;
 		void SetResizable(bool resizable);
+		// The getters above return cached values that are kept up to date by the GLFW window callbacks.
+		// This re-queries all of them from the display server, e.g. after the window has been modified through its native handle.
+		void RefreshAttributes();
 
 		void SetCursor(const Cursor &cursor);
 		void SetCursor(Cursor::Shape shape);
+		// The animation starts from the first frame and keeps running until a different cursor is set
+		void SetCursor(const std::shared_ptr<AnimatedCursor> &cursor);
 		void ClearCursor();
 	  private:
 #ifdef _WIN32
@@ -209,11 +362,123 @@ export namespace pragma::platform {
 		WindowHandle m_handle;
 		WindowCreationInfo m_creationInfo;
 		bool m_shouldCloseInvoked = false;
+		size_t m_registryIndex = 0;
+		bool m_pollRequested = false;
+		// Cached, since they're queried for every key and mouse button state lookup
+		bool m_stickyKeys = false;
+		bool m_stickyMouseButtons = false;
+		// Schedules a Poll() for the next poll_events() call
+		void RequestPoll();
 		std::string m_windowTitle;
 		CallbackInterface m_callbackInterface {};
+		// Only allocated once the first listener has been added
+		std::unique_ptr<WindowListenerLists> m_listeners;
+		template<WindowEvent TEvent>
+		WindowEventListenerList<TEvent> &GetListenerList()
+		{
+			if(!m_listeners)
+				m_listeners = std::make_unique<WindowListenerLists>();
+			return std::get<math::to_integral(TEvent)>(*m_listeners);
+		}
+		template<WindowEvent TEvent, typename... TArgs>
+		ListenerResult DispatchListeners(TArgs &&...args)
+		{
+			if(!m_listeners)
+				return ListenerResult::Continue;
+			return std::get<math::to_integral(TEvent)>(*m_listeners).Dispatch(*this, std::forward<TArgs>(args)...);
+		}
+		// GLFW callbacks that have no internal use are only installed while something would receive their events
+		enum class CallbackHook : uint8_t {
+			Refresh = 0,
+			Char,
+			CharMods,
+			CursorEnter,
+			Scroll,
+			Drop,
+			Drag,
+			Preedit,
+			IMEStatus,
+
+			Count
+		};
+		std::bitset<math::to_integral(CallbackHook::Count)> m_installedHooks {};
+		bool IsCallbackHookRequired(CallbackHook hook) const;
+		void SetCallbackHookInstalled(CallbackHook hook, bool installed);
+		void UpdateCallbackHooks();
 		std::optional<Color> m_borderColor {};
 		std::optional<Color> m_titleBarColor {};
 		std::optional<Vector2> m_cursorPosOverride = {};
+		struct Attributes {
+			Vector2i pos {};
+			Vector2i size {};
+			Vector2i framebufferSize {};
+			// GLFW has no callback for frame size changes, so it is re-queried lazily after the window has been resized
+			std::optional<Vector4i> frameSize {};
+			Vector2 cursorPos {};
+			bool focused = false;
+			bool iconified = false;
+			bool maximized = false;
+			bool visible = false;
+			bool resizable = false;
+			bool decorated = false;
+			bool floating = false;
+		};
+		mutable Attributes m_attributes {};
+		std::shared_ptr<AnimatedCursor> m_animatedCursor;
+		double m_cursorAnimationStartTime = 0.0;
+		size_t m_cursorAnimationFrame = 0;
+		void UpdateCursorAnimation();
+		std::unique_ptr<InputEventQueue> m_eventQueue;
+		struct CoalescedInput {
+			bool cursorPending = false;
+			Vector2 cursorPos {};
+			Vector2 cursorDelta {};
+			double cursorTime = 0.0;
+			bool scrollPending = false;
+			double scrollX = 0.0;
+			double scrollY = 0.0;
+			double scrollTime = 0.0;
+			// Input frame the cursor history belongs to
+			uint64_t historyFrame = 0;
+			std::vector<Vector2> cursorHistory;
+		};
+		std::unique_ptr<CoalescedInput> m_coalescedInput;
+		bool m_cursorHistoryEnabled = false;
+		std::optional<Vector2> m_lastCursorPos {};
+		Vector2 m_cursorDelta {};
+		double m_eventTime = 0.0;
+		void FlushCoalescedInput();
+		struct TextInputBatch {
+			std::vector<uint32_t> codepoints;
+			// Reused for every batch
+			std::string text;
+			bool dispatching = false;
+		};
+		std::unique_ptr<TextInputBatch> m_textInputBatch;
+		void FlushTextInput();
+		struct PreeditStorage {
+			std::string text;
+			std::vector<std::string_view> blocks;
+		};
+		PreeditStorage m_preeditText {};
+		std::shared_ptr<InputChannel> m_inputChannel;
+		InputState m_inputState {};
+		uint64_t m_inputStateFrame = 0;
+		bool IsInputStateCurrent() const;
+		void UpdateInputStateFrame();
+		std::shared_ptr<InputRecorder> m_inputRecorder;
+		void HandleEvent(InputEvent ev);
+		void CaptureEvent(InputEvent ev);
+		void CaptureDrop(int count, const char **paths, double time);
+		void DispatchDrop(const DropPathList &paths);
+		// Reused for every drop that is dispatched immediately
+		DropPathList m_dropPaths;
+		std::function<void(Window &, std::span<const DroppedFile>)> m_dropPrefetchCallback;
+		size_t m_dropPrefetchSize = 0;
+		std::vector<std::shared_ptr<detail::DropPrefetchJob>> m_dropPrefetchJobs;
+		void ProcessEvent(const InputEvent &ev);
+		void DispatchEvent(const InputEvent &ev);
+		void InvokeEventCallback(const InputEvent &ev);
 		void KeyCallback(int key, int scancode, int action, int mods);
 		void RefreshCallback();
 		void ResizeCallback(int width, int height);
@@ -230,6 +495,8 @@ export namespace pragma::platform {
 		void IconifyCallback(int iconified);
 		void WindowPosCallback(int x, int y);
 		void WindowSizeCallback(int w, int h);
+		void FramebufferSizeCallback(int w, int h);
+		void MaximizeCallback(int maximized);
 		void PreeditCallback(int preedit_count, unsigned int *preedit_string, int block_count, int *block_sizes, int focused_block, int caret);
 		void IMEStatusCallback();
 #ifdef _WIN32
@@ -238,9 +505,10 @@ export namespace pragma::platform {
 		void ReleaseFileDropHandler();
 #else
 		struct WaylandDragAndDropInfo {
-			std::chrono::steady_clock::time_point t;
-			std::vector<std::string> files;
+			TimerId timer = INVALID_TIMER_ID;
+			DropPathList files;
 		};
+		void FinishWaylandDragAndDrop();
 		std::unique_ptr<WaylandDragAndDropInfo> m_pendingWaylandDragAndDrop;
 #endif
 	};
@@ -250,3 +518,7 @@ export {
 	REGISTER_ENUM_FLAGS(pragma::platform::WindowCreationInfo::Flags)
 };
 #pragma warning(pop)
+
+namespace pragma::platform::detail {
+	void clear_clipboard_cache();
+};